@@ -0,0 +1,604 @@
+--
+-- Lua Linear benchmarks
+--
+-- Usage: lua bench/bench.lua [maxsize [mintime [pattern]]]
+--
+-- Times each function of the module across sizes, vector increments, and matrix orders, and
+-- writes one JSON record per measurement to standard output. The argument maxsize limits the
+-- number of elements (default 1E6; sizes run up to 1E8), mintime sets the minimum measured time
+-- per record in seconds (default 0.05), and pattern restricts the benchmarked functions. Times
+-- are wall clock times, read from the linear_clock helper module built by `make bench`.
+--
+
+local linear = require("linear")
+local clock = require("linear_clock").monotonic
+local unpack = table.unpack or unpack
+
+
+-- Settings
+local MAXSIZE = tonumber(arg and arg[1]) or 1E6
+local MINTIME = tonumber(arg and arg[2]) or 0.05
+local PATTERN = arg and arg[3]
+local SIZES = { 8, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8 }
+local VECTOR = { "inc", "strided" }
+local MATRIX = { "row", "col" }
+local BOTH = { "inc", "strided", "row", "col" }
+local DOUBLE = 8
+
+
+--
+-- Operands
+--
+
+-- Returns a vector with positive values; strided vectors have an increment of 2
+local function vector (n, variant)
+	local x
+	if variant == "strided" then
+		x = linear.tvector(linear.matrix(n, 2), 1)
+	else
+		x = linear.vector(n)
+	end
+	linear.uniform(x)
+	linear.inc(x, 0.5)
+	return x
+end
+
+-- Returns a matrix with positive values
+local function matrix (rows, cols, order)
+	local X = linear.matrix(rows, cols, order)
+	linear.uniform(X)
+	linear.inc(X, 0.5)
+	return X
+end
+
+-- Returns a square, diagonally dominant matrix
+local function dominant (n, order)
+	local A = matrix(n, n, order)
+	for i = 1, n do
+		A[i][i] = n
+	end
+	return A
+end
+
+-- Returns a sorted vector
+local function sorted (n, variant)
+	local x = vector(n, variant)
+	linear.sort(x)
+	return x
+end
+
+-- Returns row i of a matrix in the specified order
+local function row (X, i, order)
+	return order == "row" and X[i] or linear.tvector(X, i)
+end
+
+-- Returns the order of the matrix variant, or nil for vector variants
+local function order (variant)
+	return (variant == "row" or variant == "col") and variant or nil
+end
+
+-- Returns the dimension of square matrices with n elements
+local function dim (n)
+	return math.max(2, math.floor(math.sqrt(n)))
+end
+
+
+--
+-- Cases
+--
+-- Each case has variants, an optional maximum size, and a setup function that receives the size
+-- and the variant, and returns the run function, the number of elements processed per run, and
+-- the number of double values read and written per element.
+--
+
+local cases = {}
+
+-- Elementary functions apply to vectors and matrices in place
+local function elementary (name, ...)
+	local extra = { ... }
+	local count = select("#", ...)
+	cases[name] = { variants = BOTH, setup = function (n, variant)
+		local x
+		if order(variant) then
+			local d = dim(n)
+			x = matrix(d, d, variant)
+			n = d * d
+		else
+			x = vector(n, variant)
+		end
+		local f = linear[name]
+		return function () f(x, unpack(extra, 1, count)) end, n, 2
+	end }
+end
+
+-- Unary functions reduce vectors, or the major vectors of matrices
+local function unary (name)
+	cases[name] = { variants = BOTH, setup = function (n, variant)
+		local f = linear[name]
+		if order(variant) then
+			local d = dim(n)
+			local X, y = matrix(d, d, variant), linear.vector(d)
+			return function () f(X, y, variant) end, d * d, 1
+		end
+		local x = vector(n, variant)
+		return function () f(x) end, n, 1
+	end }
+end
+
+-- Binary functions combine two vectors or matrices
+local function binary (name, ...)
+	local extra = { ... }
+	local count = select("#", ...)
+	cases[name] = { variants = BOTH, setup = function (n, variant)
+		local f = linear[name]
+		if order(variant) then
+			local d = dim(n)
+			local X, Y = matrix(d, d, variant), matrix(d, d, variant)
+			return function () f(X, Y, unpack(extra, 1, count)) end, d * d, 3
+		end
+		local x, y = vector(n, variant), vector(n, variant)
+		return function () f(x, y, unpack(extra, 1, count)) end, n, 3
+	end }
+end
+
+-- Square matrix functions; elements are the elements of the matrix
+local function square (name, maxsize, touches, setup)
+	cases[name] = { variants = MATRIX, maxsize = maxsize, setup = function (n, variant)
+		local d = dim(n)
+		return setup(d, variant), d * d, touches
+	end }
+end
+
+-- Vector functions with a custom setup
+local function custom (name, variants, maxsize, touches, setup)
+	cases[name] = { variants = variants, maxsize = maxsize, setup = function (n, variant)
+		return setup(n, variant), n, touches
+	end }
+end
+
+-- Core functions
+custom("vector", { "inc" }, nil, 1, function (n)
+	return function () linear.vector(n) end
+end)
+square("matrix", nil, 1, function (d, variant)
+	return function () linear.matrix(d, d, variant) end
+end)
+custom("totable", { "inc", "strided" }, 1E6, 1, function (n, variant)
+	local x = vector(n, variant)
+	return function () linear.totable(x) end
+end)
+custom("tolinear", { "inc" }, 1E6, 1, function (n)
+	local t = linear.totable(vector(n))
+	return function () linear.tolinear(t) end
+end)
+custom("tovector", { "inc" }, 1E6, 1, function (n)
+	local list = {}
+	for i = 1, n do
+		list[i] = { value = i }
+	end
+	return function () linear.tovector(list, "value") end
+end)
+custom("type", { "inc" }, 8, 0, function (n)
+	local x = vector(n)
+	return function () linear.type(x) end
+end)
+custom("size", { "inc" }, 8, 0, function (n)
+	local x = vector(n)
+	return function () linear.size(x) end
+end)
+square("tvector", 8, 0, function (d, variant)
+	local X = matrix(d, d, variant)
+	return function () linear.tvector(X, 1) end
+end)
+custom("sub", { "inc" }, 8, 0, function (n)
+	local x = vector(n)
+	return function () linear.sub(x, 1, n) end
+end)
+square("unwind", nil, 2, function (d, variant)
+	local X, x = matrix(d, d, variant), linear.vector(d * d)
+	return function () linear.unwind(X, x) end
+end)
+square("reshape", nil, 2, function (d, variant)
+	local X, x = matrix(d, d, variant), vector(d * d)
+	return function () linear.reshape(x, X) end
+end)
+custom("randomseed", { "inc" }, 8, 0, function ()
+	return function () linear.randomseed(1) end
+end)
+custom("rng", { "inc" }, 8, 0, function ()
+	return function () linear.rng(1) end
+end)
+if linear.ipairs then
+	custom("ipairs", { "inc", "strided" }, nil, 1, function (n, variant)
+		local x = vector(n, variant)
+		return function () for _ in linear.ipairs(x) do end end
+	end)
+end
+
+-- Elementary functions
+elementary("inc", 0.0)
+elementary("scal", 1.0)
+elementary("pow", 1.0)
+elementary("exp")
+elementary("log")
+elementary("sgn")
+elementary("abs")
+elementary("logistic")
+elementary("tanh")
+elementary("apply", function (v) return v end)
+elementary("set", 0.5)
+elementary("clip", 0.0, 1.0)
+elementary("uniform")
+elementary("normal")
+elementary("normalpdf")
+elementary("normalcdf")
+elementary("normalqf")
+elementary("exponential")
+elementary("gamma", 2.5)
+elementary("beta", 2.0, 5.0)
+elementary("poisson", 30.0)
+elementary("binomial", 100, 0.3)
+elementary("studentt", 5.0)
+
+-- Unary functions
+for _, name in ipairs({ "sum", "mean", "var", "std", "skew", "kurt", "median", "mad", "nrm2",
+		"asum", "min", "max" }) do
+	unary(name)
+end
+
+-- Binary functions
+binary("axpy")
+binary("axpby")
+binary("mul")
+binary("swap")
+binary("copy")
+
+-- Program functions
+custom("dot", VECTOR, nil, 2, function (n, variant)
+	local x, y = vector(n, variant), vector(n, variant)
+	return function () linear.dot(x, y) end
+end)
+square("ger", nil, 2, function (d, variant)
+	local x, y, A = vector(d), vector(d), matrix(d, d, variant)
+	return function () linear.ger(x, y, A, 0.0) end
+end)
+square("gemv", nil, 1, function (d, variant)
+	local A, x, y = matrix(d, d, variant), vector(d), vector(d)
+	return function () linear.gemv(A, x, y) end
+end)
+square("gemm", 1E6, 3, function (d, variant)
+	local A, B, C = matrix(d, d, variant), matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.gemm(A, B, C) end
+end)
+square("trmv", nil, 1, function (d, variant)
+	local A, x = dominant(d, variant), vector(d)
+	return function () linear.trmv(A, x) end
+end)
+square("trsv", nil, 1, function (d, variant)
+	local A, x = dominant(d, variant), vector(d)
+	return function () linear.trsv(A, x) end
+end)
+square("trmm", 1E6, 2, function (d, variant)
+	local A, B = dominant(d, variant), matrix(d, d, variant)
+	return function () linear.trmm(A, B) end
+end)
+square("trsm", 1E6, 2, function (d, variant)
+	local A, B = dominant(d, variant), matrix(d, d, variant)
+	return function () linear.trsm(A, B) end
+end)
+square("syr", nil, 2, function (d, variant)
+	local x, A = vector(d), matrix(d, d, variant)
+	return function () linear.syr(x, A, "upper", 0.0) end
+end)
+square("symv", nil, 1, function (d, variant)
+	local A, x, y = matrix(d, d, variant), vector(d), vector(d)
+	return function () linear.symv(A, x, y) end
+end)
+square("symm", 1E6, 3, function (d, variant)
+	local A, B, C = matrix(d, d, variant), matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.symm(A, B, C) end
+end)
+square("syrk", 1E6, 2, function (d, variant)
+	local A, C = matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.syrk(A, C) end
+end)
+square("syr2k", 1E6, 3, function (d, variant)
+	local A, B, C = matrix(d, d, variant), matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.syr2k(A, B, C) end
+end)
+square("gesv", 1E6, 4, function (d, variant)
+	local A0, A, B = dominant(d, variant), matrix(d, d, variant), matrix(d, 1, variant)
+	return function ()
+		linear.copy(A0, A)
+		linear.gesv(A, B)
+	end
+end)
+square("gels", 1E6, 4, function (d, variant)
+	local A0, A, B = dominant(d, variant), matrix(d, d, variant), matrix(d, 1, variant)
+	return function ()
+		linear.copy(A0, A)
+		linear.gels(A, B)
+	end
+end)
+custom("gtsv", { "inc" }, nil, 4, function (n)
+	n = math.max(n, 2)
+	local dl, d, du, b = vector(n - 1), vector(n), vector(n - 1), vector(n)
+	linear.inc(d, 4)
+	return function () linear.gtsv(dl, d, du, b) end
+end)
+custom("gbsv", MATRIX, nil, 4, function (n, variant)
+	local AB, b = matrix(3, n, variant), vector(n)
+	linear.inc(row(AB, 2, variant), 4)
+	return function () linear.gbsv(AB, 1, b) end
+end)
+custom("pbsv", MATRIX, nil, 3, function (n, variant)
+	local AB, b = matrix(2, n, variant), vector(n)
+	linear.inc(row(AB, 2, variant), 4)
+	return function () linear.pbsv(AB, b) end
+end)
+custom("gttrf", { "inc" }, nil, 3, function (n)
+	n = math.max(n, 2)
+	local dl, d, du = vector(n - 1), vector(n), vector(n - 1)
+	linear.inc(d, 4)
+	return function () linear.gttrf(dl, d, du) end
+end)
+custom("gbtrf", MATRIX, nil, 3, function (n, variant)
+	local AB = matrix(3, n, variant)
+	linear.inc(row(AB, 2, variant), 4)
+	return function () linear.gbtrf(AB, 1) end
+end)
+custom("pbtrf", MATRIX, nil, 2, function (n, variant)
+	local AB = matrix(2, n, variant)
+	linear.inc(row(AB, 2, variant), 4)
+	return function () linear.pbtrf(AB) end
+end)
+square("inv", 1E6, 4, function (d, variant)
+	local A0, A = dominant(d, variant), matrix(d, d, variant)
+	return function ()
+		linear.copy(A0, A)
+		linear.inv(A)
+	end
+end)
+square("det", 1E6, 2, function (d, variant)
+	local A = dominant(d, variant)
+	return function () linear.det(A) end
+end)
+square("svd", 1E5, 4, function (d, variant)
+	local A0, A = matrix(d, d, variant), matrix(d, d, variant)
+	local U, s, VT = matrix(d, d, variant), linear.vector(d), matrix(d, d, variant)
+	return function ()
+		linear.copy(A0, A)
+		linear.svd(A, U, s, VT)
+	end
+end)
+square("rsvd", 1E6, 2, function (d, variant)
+	local k = math.max(1, math.floor(d / 10))
+	local A, U, s, VT = matrix(d, d, variant), matrix(d, k, variant), linear.vector(k),
+			matrix(k, d, variant)
+	return function () linear.rsvd(A, U, s, VT) end
+end)
+square("cov", 1E6, 2, function (d, variant)
+	local A, B = matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.cov(A, B) end
+end)
+square("corr", 1E6, 2, function (d, variant)
+	local A, B = matrix(d, d, variant), matrix(d, d, variant)
+	return function () linear.corr(A, B) end
+end)
+custom("ranks", { "inc" }, nil, 1, function (n)
+	local r = linear.vector(math.max(n - 1, 1))
+	return function () linear.ranks(math.max(n, 2), r) end
+end)
+custom("quantile", BOTH, nil, 2, function (n, variant)
+	local r = linear.tolinear({ 0.25, 0.5, 0.75 })
+	if order(variant) then
+		local d = dim(n)
+		local V = matrix(d, d, variant)
+		local Q = variant == "row" and linear.matrix(d, 3) or linear.matrix(3, d)
+		return function () linear.quantile(V, r, Q, variant) end
+	end
+	local v = vector(n, variant)
+	return function () linear.quantile(v, r) end
+end)
+custom("rank", VECTOR, nil, 2, function (n, variant)
+	local v, q = vector(n, variant), vector(n, variant)
+	return function () linear.rank(v, q) end
+end)
+custom("sort", VECTOR, nil, 2, function (n, variant)
+	local x0, x = vector(n, variant), vector(n, variant)
+	return function ()
+		linear.copy(x0, x)
+		linear.sort(x)
+	end
+end)
+custom("argsort", VECTOR, nil, 2, function (n, variant)
+	local x, p = vector(n, variant), vector(n, variant)
+	return function () linear.argsort(x, p) end
+end)
+custom("permute", BOTH, nil, 3, function (n, variant)
+	if order(variant) then
+		local d = dim(n)
+		local X, p, Y = matrix(d, d, variant), linear.vector(d), matrix(d, d, variant)
+		linear.argsort(vector(d), p)
+		return function () linear.permute(X, p, Y, variant) end
+	end
+	local x, p, y = vector(n, variant), linear.vector(n), vector(n, variant)
+	linear.argsort(vector(n), p)
+	return function () linear.permute(x, p, y) end
+end)
+custom("shuffle", BOTH, nil, 2, function (n, variant)
+	if order(variant) then
+		local d = dim(n)
+		local X = matrix(d, d, variant)
+		return function () linear.shuffle(X, variant) end
+	end
+	local x = vector(n, variant)
+	return function () linear.shuffle(x) end
+end)
+custom("sample", BOTH, nil, 2, function (n, variant)
+	if order(variant) then
+		local d = dim(n)
+		local X, Y = matrix(d, d, variant), matrix(d, d, variant)
+		return function () linear.sample(X, Y, true, variant) end
+	end
+	local x, y = vector(n, variant), vector(n, variant)
+	return function () linear.sample(x, y, true) end
+end)
+custom("searchsorted", VECTOR, nil, 3, function (n, variant)
+	local x, v, c = sorted(n, variant), vector(n, variant), vector(n, variant)
+	return function () linear.searchsorted(x, v, c) end
+end)
+custom("topk", VECTOR, nil, 1, function (n, variant)
+	local x, v = vector(n, variant), linear.vector(math.min(n, 10))
+	return function () linear.topk(x, v) end
+end)
+custom("spline", { "inc" }, nil, 6, function (n)
+	n = math.max(n, 4)
+	local x, y = linear.vector(n), vector(n)
+	for i = 1, n do
+		x[i] = i
+	end
+	return function () linear.spline(x, y) end
+end)
+custom("interp", VECTOR, nil, 4, function (n, variant)
+	n = math.max(n, 2)
+	local xp, fp = linear.vector(n), vector(n)
+	for i = 1, n do
+		xp[i] = i
+	end
+	local x, y = vector(n, variant), vector(n, variant)
+	linear.uniform(x)
+	linear.scal(x, n - 1)
+	linear.inc(x, 1)
+	return function () linear.interp(xp, fp, x, y) end
+end)
+
+-- Sparse functions; elements are the stored elements, eight per row
+local function sparse (n)
+	local rows = math.max(1, math.floor(n / 8))
+	local nnz = rows * 8
+	local i, j, v = linear.vector(nnz), linear.vector(nnz), vector(nnz)
+	for k = 1, nnz do
+		i[k] = math.floor((k - 1) / 8) + 1
+		j[k] = math.random(rows)
+	end
+	return linear.sparse(rows, rows, i, j, v), rows, nnz
+end
+
+cases.sparse = { variants = MATRIX, maxsize = 1E7, setup = function (n, variant)
+	local d = dim(n)
+	local X = matrix(d, d, variant)
+	return function () linear.sparse(X) end, d * d, 1
+end }
+cases.spdense = { variants = MATRIX, maxsize = 1E7, setup = function (n, variant)
+	local S, rows, nnz = sparse(n)
+	local X = linear.matrix(rows, rows, variant)
+	return function () linear.spdense(S, X) end, nnz, 2
+end }
+cases.spmv = { variants = { "inc" }, setup = function (n)
+	local S, rows, nnz = sparse(n)
+	local x, y = vector(rows), vector(rows)
+	return function () linear.spmv(S, x, y) end, nnz, 3
+end }
+cases.spmm = { variants = MATRIX, maxsize = 1E7, setup = function (n, variant)
+	local S, rows, nnz = sparse(n)
+	local B, C = matrix(rows, 4, variant), matrix(rows, 4, variant)
+	return function () linear.spmm(S, B, C) end, nnz * 4, 3
+end }
+cases.spscal = { variants = { "inc" }, setup = function (n)
+	local S, rows, nnz = sparse(n)
+	local x = linear.vector(rows)
+	linear.set(x, 1.0)
+	return function () linear.spscal(S, x) end, nnz, 2
+end }
+cases.spsum = { variants = MATRIX, setup = function (n, variant)
+	local S, rows, nnz = sparse(n)
+	local y = linear.vector(rows)
+	return function () linear.spsum(S, y, variant) end, nnz, 1
+end }
+
+
+--
+-- Measurement
+--
+
+-- Returns the seconds per run of the run function, and the number of runs measured
+local function measure (run)
+	local runs = 1
+	run()
+	while true do
+		local start = clock()
+		for _ = 1, runs do
+			run()
+		end
+		local elapsed = clock() - start
+		if elapsed >= MINTIME or runs >= 2 ^ 30 then
+			return elapsed / runs, runs
+		end
+		runs = elapsed > 0 and math.min(runs * 8, math.ceil(runs * MINTIME * 1.2 / elapsed))
+				or runs * 8
+	end
+end
+
+-- Formats a record as a JSON object
+local function json (record)
+	local fields = {}
+	for _, key in ipairs({ "function", "variant", "size", "elements", "runs", "seconds",
+			"ns_per_element", "gb_per_s", "skipped" }) do
+		local value = record[key]
+		if type(value) == "string" then
+			fields[#fields + 1] = string.format("%q: %q", key, value)
+		elseif type(value) == "number" then
+			fields[#fields + 1] = string.format("%q: %.6g", key, value)
+		elseif type(value) == "boolean" then
+			fields[#fields + 1] = string.format("%q: %s", key, tostring(value))
+		end
+	end
+	return "{" .. table.concat(fields, ", ") .. "}"
+end
+
+
+--
+-- Main
+--
+
+local names = {}
+for name, value in pairs(linear) do
+	if type(value) == "function" and (not PATTERN or name:match(PATTERN)) then
+		names[#names + 1] = name
+	end
+end
+table.sort(names)
+local records = {}
+for _, name in ipairs(names) do
+	local case = cases[name]
+	if not case then
+		records[#records + 1] = { ["function"] = name, skipped = true }
+	else
+		for _, size in ipairs(SIZES) do
+			if size <= MAXSIZE and size <= (case.maxsize or math.huge) then
+				for _, variant in ipairs(case.variants) do
+					io.stderr:write(string.format("%s %s %d\n", name, variant, size))
+					local run, elements, touches = case.setup(size, variant)
+					local seconds, runs = measure(run)
+					records[#records + 1] = {
+						["function"] = name,
+						variant = variant,
+						size = size,
+						elements = elements,
+						runs = runs,
+						seconds = seconds,
+						ns_per_element = seconds / elements * 1E9,
+						gb_per_s = elements * touches * DOUBLE / seconds / 1E9
+					}
+					collectgarbage()
+				end
+			end
+		end
+	end
+end
+io.write("[\n")
+for i, record in ipairs(records) do
+	io.write("\t", json(record), i < #records and ",\n" or "\n")
+end
+io.write("]\n")
@@ -0,0 +1,30 @@
+/*
+ * Lua Linear benchmark clock
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+#include <time.h>
+#include <lua.h>
+
+
+static int linear_clock_monotonic(lua_State *L);
+int luaopen_linear_clock(lua_State *L);
+
+
+static int linear_clock_monotonic (lua_State *L) {
+	struct timespec  ts;
+
+	/* wall clock time in seconds; unlike os.clock, not summed over threads */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	lua_pushnumber(L, (lua_Number)ts.tv_sec + (lua_Number)ts.tv_nsec * 1E-9);
+	return 1;
+}
+
+int luaopen_linear_clock (lua_State *L) {
+	lua_newtable(L);
+	lua_pushcfunction(L, linear_clock_monotonic);
+	lua_setfield(L, -2, "monotonic");
+	return 1;
+}
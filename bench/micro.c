@@ -0,0 +1,309 @@
+/*
+ * Lua Linear microbenchmarks
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <lauxlib.h>
+#include "micro.h"
+
+
+#define LINEAR_MICRO_MINTIME  20000000  /* minimum measured time in nanoseconds */
+#define LINEAR_MICRO_MAXSIZE  1000000   /* default maximum size */
+
+
+typedef enum linear_micro_path_e {
+	LINEAR_MICRO_HANDLER,   /* handler called directly */
+	LINEAR_MICRO_DISPATCH,  /* handler called through the Lua dispatch function */
+	LINEAR_MICRO_BLAS,      /* BLAS equivalent */
+	LINEAR_MICRO_RESTORE    /* input restore, subtracted from restoring handlers */
+} linear_micro_path_e;
+
+typedef struct linear_micro_run_s {
+	const linear_micro_t  *micro;
+	linear_micro_path_e    path;
+	lua_State             *L;
+	int                    top;
+	size_t                 size;
+	double                *x, *y, *xsource, *ysource;
+	linear_arg_u           args[LINEAR_PARAMS_MAX];
+} linear_micro_run_t;
+
+
+static inline uint64_t linear_micro_cycles(void);
+static inline uint64_t linear_micro_ns(void);
+static int linear_micro_blas(linear_micro_run_t *run, int execute);
+static void linear_micro_once(linear_micro_run_t *run);
+static void linear_micro_measure(linear_micro_run_t *run, double *cycles, double *ns);
+static void linear_micro_report(linear_micro_run_t *run, const char *path, double baseline,
+		double *result);
+static double *linear_micro_source(const linear_micro_t *micro, size_t size);
+static void linear_micro_size(lua_State *L, const linear_micro_t *micro, size_t size);
+
+
+static inline uint64_t linear_micro_cycles (void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static inline uint64_t linear_micro_ns (void) {
+	struct timespec  ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int linear_micro_blas (linear_micro_run_t *run, int execute) {
+	const char  *name;
+	size_t       n;
+	double      *x, *y;
+
+	/* runs the BLAS equivalent of the function, if any; sum uses a dot product with a constant */
+	name = run->micro->name;
+	n = run->size;
+	x = run->x;
+	y = run->y;
+	if (strcmp(name, "scal") == 0) {
+		if (execute) {
+			cblas_dscal(n, run->micro->alpha, x, 1);
+		}
+	} else if (strcmp(name, "axpy") == 0) {
+		if (execute) {
+			cblas_daxpy(n, 1.0, x, 1, y, 1);
+		}
+#if LINEAR_USE_AXPBY
+	} else if (strcmp(name, "axpby") == 0) {
+		if (execute) {
+			cblas_daxpby(n, 1.0, x, 1, 1.0, y, 1);
+		}
+#endif
+	} else if (strcmp(name, "swap") == 0) {
+		if (execute) {
+			cblas_dswap(n, x, 1, y, 1);
+		}
+	} else if (strcmp(name, "copy") == 0) {
+		if (execute) {
+			cblas_dcopy(n, x, 1, y, 1);
+		}
+	} else if (strcmp(name, "sum") == 0) {
+		if (execute) {
+			cblas_ddot(n, x, 1, run->xsource, 0);
+		}
+	} else if (strcmp(name, "nrm2") == 0) {
+		if (execute) {
+			cblas_dnrm2(n, x, 1);
+		}
+	} else if (strcmp(name, "asum") == 0) {
+		if (execute) {
+			cblas_dasum(n, x, 1);
+		}
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+static void linear_micro_once (linear_micro_run_t *run) {
+	const linear_micro_t  *micro;
+
+	micro = run->micro;
+	if (micro->restore & LINEAR_MICRO_X) {
+		memcpy(run->x, run->xsource, run->size * sizeof(double));
+	}
+	if (micro->restore & LINEAR_MICRO_Y) {
+		memcpy(run->y, run->ysource, run->size * sizeof(double));
+	}
+	switch (run->path) {
+	case LINEAR_MICRO_HANDLER:
+		if (micro->elementary) {
+			micro->elementary(run->size, run->x, 1, run->args);
+		} else if (micro->unary) {
+			micro->unary(run->size, run->x, 1, run->args);
+		} else {
+			micro->binary(run->size, run->x, 1, run->y, 1, run->args);
+		}
+		break;
+
+	case LINEAR_MICRO_DISPATCH:
+		if (micro->elementary) {
+			linear_elementary(run->L, micro->elementary, micro->params);
+		} else if (micro->unary) {
+			linear_unary(run->L, micro->unary, micro->params);
+		} else {
+			linear_binary(run->L, micro->binary, micro->params);
+		}
+		lua_settop(run->L, run->top);
+		break;
+
+	case LINEAR_MICRO_BLAS:
+		linear_micro_blas(run, 1);
+		break;
+
+	case LINEAR_MICRO_RESTORE:
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void linear_micro_measure (linear_micro_run_t *run, double *cycles, double *ns) {
+	size_t    i, runs;
+	uint64_t  c0, t0, c1, t1;
+
+	/* double the runs until the minimum time is reached */
+	linear_micro_once(run);
+	runs = 1;
+	for (;;) {
+		t0 = linear_micro_ns();
+		c0 = linear_micro_cycles();
+		for (i = 0; i < runs; i++) {
+			linear_micro_once(run);
+		}
+		c1 = linear_micro_cycles();
+		t1 = linear_micro_ns();
+		if (t1 - t0 >= LINEAR_MICRO_MINTIME) {
+			break;
+		}
+		runs *= 2;
+	}
+	*cycles = (double)(c1 - c0) / runs;
+	*ns = (double)(t1 - t0) / runs;
+}
+
+static void linear_micro_report (linear_micro_run_t *run, const char *path, double baseline,
+		double *result) {
+	double  cycles, ns, restore_cycles, restore_ns;
+
+	linear_micro_measure(run, &cycles, &ns);
+	if (run->micro->restore) {
+		/* subtract the cost of restoring the input */
+		run->path = LINEAR_MICRO_RESTORE;
+		linear_micro_measure(run, &restore_cycles, &restore_ns);
+		cycles = cycles > restore_cycles ? cycles - restore_cycles : 0.0;
+		ns = ns > restore_ns ? ns - restore_ns : 0.0;
+	}
+	printf("%-12s %-9s %10zu %12.3f %12.3f", run->micro->name, path, run->size,
+			cycles / run->size, ns / run->size);
+	if (baseline > 0) {
+		printf(" %10.2f", ns / baseline);
+	}
+	printf("\n");
+	if (result != NULL) {
+		*result = ns;
+	}
+}
+
+static double *linear_micro_source (const linear_micro_t *micro, size_t size) {
+	size_t   i;
+	double   lower, upper, *source;
+
+	/* draw the inputs from the open domain of the handler */
+	source = malloc(size * sizeof(double));
+	if (source == NULL) {
+		fprintf(stderr, "cannot allocate values\n");
+		exit(EXIT_FAILURE);
+	}
+	lower = micro->lower;
+	upper = micro->upper;
+	if (lower == 0 && upper == 0) {
+		lower = 0.5;
+		upper = 1.5;
+	}
+	for (i = 0; i < size; i++) {
+		source[i] = lower + (upper - lower) * (rand() + 1.0) / (RAND_MAX + 2.0);
+	}
+	return source;
+}
+
+static void linear_micro_size (lua_State *L, const linear_micro_t *micro, size_t size) {
+	double               blas;
+	linear_vector_t     *x, *y;
+	linear_micro_run_t   run;
+
+	/* set up the vectors on the Lua stack, as the dispatch functions expect them */
+	lua_settop(L, 0);
+	x = linear_create_vector(L, size);
+	y = micro->binary ? linear_create_vector(L, size) : NULL;
+	if (micro->alpha != 0) {
+		lua_pushnumber(L, micro->alpha);
+	}
+	run.micro = micro;
+	run.L = L;
+	run.top = lua_gettop(L);
+	run.size = size;
+	run.x = x->values;
+	run.y = y ? y->values : NULL;
+	run.xsource = linear_micro_source(micro, size);
+	memcpy(run.x, run.xsource, size * sizeof(double));
+	run.ysource = NULL;
+	if (run.y) {
+		run.ysource = linear_micro_source(micro, size);
+		memcpy(run.y, run.ysource, size * sizeof(double));
+	}
+	linear_checkargs(L, micro->binary ? 3 : 2, size, micro->params, run.args);
+
+	/* BLAS first, so that the handler can be reported relative to it */
+	blas = 0.0;
+	if (linear_micro_blas(&run, 0)) {
+		run.path = LINEAR_MICRO_BLAS;
+		linear_micro_report(&run, "blas", 0.0, &blas);
+	}
+	run.path = LINEAR_MICRO_HANDLER;
+	linear_micro_report(&run, "handler", blas, NULL);
+	run.path = LINEAR_MICRO_DISPATCH;
+	linear_micro_report(&run, "dispatch", blas, NULL);
+	free(run.xsource);
+	free(run.ysource);
+}
+
+int main (int argc, char *argv[]) {
+	size_t                  size, maxsize;
+	const char             *pattern;
+	lua_State              *L;
+	const linear_micro_t   *micro;
+	const linear_micro_t   *tables[] = {linear_micro_elementary, linear_micro_unary,
+			linear_micro_binary, NULL};
+	const linear_micro_t  **table;
+
+	/* process arguments */
+	maxsize = argc > 1 ? (size_t)strtod(argv[1], NULL) : LINEAR_MICRO_MAXSIZE;
+	pattern = argc > 2 ? argv[2] : NULL;
+
+	/* open the module for its metatables and random state */
+	L = luaL_newstate();
+	if (L == NULL) {
+		fprintf(stderr, "cannot create Lua state\n");
+		return EXIT_FAILURE;
+	}
+	lua_pushcfunction(L, luaopen_linear);
+	lua_call(L, 0, 0);
+
+	/* run */
+	printf("%-12s %-9s %10s %12s %12s %10s\n", "function", "path", "size", "cycles/elem",
+			"ns/elem", "vs_blas");
+	for (table = tables; *table; table++) {
+		for (micro = *table; micro->name; micro++) {
+			if (pattern && strstr(micro->name, pattern) == NULL) {
+				continue;
+			}
+			for (size = 8; size <= maxsize; size *= 8) {
+				linear_micro_size(L, micro, size);
+			}
+		}
+	}
+	lua_close(L);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,40 @@
+/*
+ * Lua Linear microbenchmarks
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+#ifndef _LINEAR_MICRO_INCLUDED
+#define _LINEAR_MICRO_INCLUDED
+
+
+#include "../src/linear_core.h"
+#include "../src/linear_elementary.h"
+#include "../src/linear_unary.h"
+#include "../src/linear_binary.h"
+
+
+#define LINEAR_MICRO_X  1  /* restore the first argument */
+#define LINEAR_MICRO_Y  2  /* restore the second argument */
+
+
+typedef struct linear_micro_s {
+	const char                  *name;        /* function name */
+	linear_elementary_function   elementary;  /* elementary handler, or NULL */
+	linear_unary_function        unary;       /* unary handler, or NULL */
+	linear_binary_function       binary;      /* binary handler, or NULL */
+	linear_param_t              *params;      /* handler params */
+	lua_Number                   alpha;       /* first argument; 0 selects the default */
+	int                          restore;     /* arguments leaving their domain; restored */
+	double                       lower;       /* input domain, open; 0, 0 selects (0.5, 1.5) */
+	double                       upper;
+} linear_micro_t;
+
+
+extern const linear_micro_t linear_micro_elementary[];
+extern const linear_micro_t linear_micro_unary[];
+extern const linear_micro_t linear_micro_binary[];
+
+
+#endif /* _LINEAR_MICRO_INCLUDED */
@@ -0,0 +1,20 @@
+/*
+ * Lua Linear binary microbenchmarks
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+/* the handlers are static; include the module to reach them */
+#include "../src/linear_binary.c"
+#include "micro.h"
+
+
+const linear_micro_t linear_micro_binary[] = {
+	{"axpy", NULL, NULL, linear_axpy_handler, linear_params_alpha, 0, 0, 0, 0},
+	{"axpby", NULL, NULL, linear_axpby_handler, linear_params_alpha_beta, 0, 0, 0, 0},
+	{"mul", NULL, NULL, linear_mul_handler, linear_params_alpha, 0, LINEAR_MICRO_Y, 0, 0},
+	{"swap", NULL, NULL, linear_swap_handler, linear_params_none, 0, 0, 0, 0},
+	{"copy", NULL, NULL, linear_copy_handler, linear_params_none, 0, 0, 0, 0},
+	{NULL, NULL, NULL, NULL, NULL, 0, 0, 0, 0}
+};
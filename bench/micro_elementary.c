@@ -0,0 +1,41 @@
+/*
+ * Lua Linear elementary microbenchmarks
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+/* the handlers are static; include the module to reach them */
+#include "../src/linear_elementary.c"
+#include "micro.h"
+
+
+const linear_micro_t linear_micro_elementary[] = {
+	{"inc", linear_inc_handler, NULL, NULL, linear_params_alpha, 0, 0, 0, 0},
+	{"scal", linear_scal_handler, NULL, NULL, linear_params_alpha, -1, 0, 0, 0},
+	{"pow", linear_pow_handler, NULL, NULL, linear_params_alpha, 2, LINEAR_MICRO_X, 0, 0},
+	{"exp", linear_exp_handler, NULL, NULL, linear_params_none, 0, LINEAR_MICRO_X, 0, 0},
+	{"log", linear_log_handler, NULL, NULL, linear_params_none, 0, LINEAR_MICRO_X, 0, 0},
+	{"sgn", linear_sgn_handler, NULL, NULL, linear_params_none, 0, 0, 0, 0},
+	{"abs", linear_abs_handler, NULL, NULL, linear_params_none, 0, 0, 0, 0},
+	{"logistic", linear_logistic_handler, NULL, NULL, linear_params_none, 0, 0, 0, 0},
+	{"tanh", linear_tanh_handler, NULL, NULL, linear_params_none, 0, LINEAR_MICRO_X, 0, 0},
+	{"set", linear_set_handler, NULL, NULL, linear_params_alpha, 0, 0, 0, 0},
+	{"clip", linear_clip_handler, NULL, NULL, linear_params_min_max, 0, 0, 0, 0},
+	{"uniform", linear_uniform_handler, NULL, NULL, linear_params_random, 0, 0, 0, 0},
+	{"normal", linear_normal_handler, NULL, NULL, linear_params_random, 0, 0, 0, 0},
+	{"normalpdf", linear_normalpdf_handler, NULL, NULL,
+			linear_params_mu_sigma, 0, LINEAR_MICRO_X, 0, 0},
+	{"normalcdf", linear_normalcdf_handler, NULL, NULL,
+			linear_params_mu_sigma, 0, LINEAR_MICRO_X, 0, 0},
+	{"normalqf", linear_normalqf_handler, NULL, NULL,
+			linear_params_mu_sigma, 0, LINEAR_MICRO_X, 0, 1},
+	{"exponential", linear_exponential_handler, NULL, NULL,
+			linear_params_lambda_random, 0, 0, 0, 0},
+	{"gamma", linear_gamma_handler, NULL, NULL, linear_params_k_theta_random, 0, 0, 0, 0},
+	{"beta", linear_beta_handler, NULL, NULL, linear_params_alpha_beta_random, 0, 0, 0, 0},
+	{"poisson", linear_poisson_handler, NULL, NULL, linear_params_lambda_random, 0, 0, 0, 0},
+	{"binomial", linear_binomial_handler, NULL, NULL, linear_params_n_p_random, 0, 0, 0, 0},
+	{"studentt", linear_studentt_handler, NULL, NULL, linear_params_nu_random, 0, 0, 0, 0},
+	{NULL, NULL, NULL, NULL, NULL, 0, 0, 0, 0}
+};
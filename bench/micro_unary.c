@@ -0,0 +1,27 @@
+/*
+ * Lua Linear unary microbenchmarks
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+/* the handlers are static; include the module to reach them */
+#include "../src/linear_unary.c"
+#include "micro.h"
+
+
+const linear_micro_t linear_micro_unary[] = {
+	{"sum", NULL, linear_sum_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{"mean", NULL, linear_mean_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{"var", NULL, linear_var_handler, NULL, linear_params_ddof, 0, 0, 0, 0},
+	{"std", NULL, linear_std_handler, NULL, linear_params_ddof, 0, 0, 0, 0},
+	{"skew", NULL, linear_skew_handler, NULL, linear_params_set, 0, 0, 0, 0},
+	{"kurt", NULL, linear_kurt_handler, NULL, linear_params_set, 0, 0, 0, 0},
+	{"median", NULL, linear_median_handler, NULL, linear_params_lua, 0, 0, 0, 0},
+	{"mad", NULL, linear_mad_handler, NULL, linear_params_lua, 0, 0, 0, 0},
+	{"nrm2", NULL, linear_nrm2_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{"asum", NULL, linear_asum_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{"min", NULL, linear_min_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{"max", NULL, linear_max_handler, NULL, linear_params_none, 0, 0, 0, 0},
+	{NULL, NULL, NULL, NULL, NULL, 0, 0, 0, 0}
+};
@@ -16,6 +16,10 @@
 #endif
 
 
+#define LINEAR_BLOCK_SIZE  64  /* block size of mixed order matrix-matrix operations */
+
+
+static int linear_binary_call(lua_State *L, linear_binary_function f, linear_param_t *params);
 static void linear_axpy_handler(size_t size, double *x, size_t incx, double *y, size_t incy,
 		linear_arg_u *args);
 static int linear_axpy(lua_State *L);
@@ -48,7 +52,20 @@ static linear_param_t linear_params_alpha_beta[] = {
 
 
 int linear_binary (lua_State *L, linear_binary_function f, linear_param_t *params) {
-	size_t            i;
+	int                    results;
+	linear_profile_call_t  call;
+
+	if (!linear_isprofiling()) {
+		return linear_binary_call(L, f, params);
+	}
+	linear_profile_start(L, 1, &call);
+	results = linear_binary_call(L, f, params);
+	linear_profile_stop(L, &call);
+	return results;
+}
+
+static int linear_binary_call (lua_State *L, linear_binary_function f, linear_param_t *params) {
+	size_t            i, j, major, minor, block;
 	linear_arg_u      args[LINEAR_PARAMS_MAX];
 	linear_vector_t  *x, *y;
 	linear_matrix_t  *X, *Y;
@@ -102,9 +119,25 @@ int linear_binary (lua_State *L, linear_binary_function f, linear_param_t *param
 	if (X != NULL) {
 		/* matrix-matrix */
 		Y = luaL_checkudata(L, 2, LINEAR_MATRIX);
-		luaL_argcheck(L, X->order == Y->order, 2, "order mismatch");
 		luaL_argcheck(L, X->rows == Y->rows && X->cols == Y->cols, 2, "dimension mismatch");
-		if (X->order == CblasRowMajor) {
+		if (X->order != Y->order) {
+			/* mixed order; the major vectors of X are the minor vectors of Y */
+			if (Y->order == CblasRowMajor) {
+				major = Y->rows;
+				minor = Y->cols;
+			} else {
+				major = Y->cols;
+				minor = Y->rows;
+			}
+			linear_checkargs(L, 3, minor, params, args);
+			for (i = 0; i < minor; i += LINEAR_BLOCK_SIZE) {
+				block = minor - i < LINEAR_BLOCK_SIZE ? minor - i : LINEAR_BLOCK_SIZE;
+				for (j = 0; j < major; j++) {
+					f(block, &X->values[i * X->ld + j], X->ld,
+							&Y->values[j * Y->ld + i], 1, args);
+				}
+			}
+		} else if (X->order == CblasRowMajor) {
 			linear_checkargs(L, 3, X->cols, params, args);
 			if (X->ld == X->cols && Y->ld == Y->cols && X->rows * X->cols <= INT_MAX) {
 				f(X->rows * X->cols, X->values, 1, Y->values, 1, args);
@@ -6,17 +6,27 @@
 
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <float.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#if LINEAR_USE_PERF && defined(__linux__)
+#include <linux/perf_event.h>
+#endif
 #include <lauxlib.h>
 #include "linear_core.h"
 #include "linear_elementary.h"
 #include "linear_unary.h"
 #include "linear_binary.h"
 #include "linear_program.h"
+#include "linear_sparse.h"
 
 
 /* compatibility */
@@ -26,6 +36,58 @@
 #endif
 
 
+#define LINEAR_SORT_INSERTION   32                     /* maximum size of insertion sorts */
+#define LINEAR_SORT_SIGN        ((uint64_t)1 << 63)  /* sign bit */
+#define LINEAR_RANDOM_LANES     4                      /* number of interleaved random lanes */
+#define LINEAR_RANDOM_LANESMIN  1024                   /* minimum size of interleaved fills */
+#define LINEAR_PHILOX_M0        0xd2511f53             /* Philox multipliers */
+#define LINEAR_PHILOX_M1        0xcd9e8d57
+#define LINEAR_PHILOX_W0        0x9e3779b9             /* Philox Weyl key increments */
+#define LINEAR_PHILOX_W1        0xbb67ae85
+#define LINEAR_PROFILE_NAMES    "linear.profilenames"  /* profiled function names */
+#define LINEAR_PROFILE_RECORDS  "linear.profiledata"   /* profile records */
+#define LINEAR_PROFILE_BUCKETS  64                     /* size histogram buckets */
+#define LINEAR_TRACE_CAPACITY   65536                  /* default trace capacity */
+#define LINEAR_TRACE_NAME       16                     /* maximum trace name length */
+#define LINEAR_PARALLEL_THREADS 8                      /* maximum number of threads */
+#define LINEAR_PARALLEL_WORK    65536                  /* minimum amount of work for threads */
+
+
+typedef struct linear_profile_s {
+	int  enabled;                 /* profiling enabled */
+	int  leader;                  /* counter group leader, or -1 */
+	int  fds[LINEAR_COUNTERS];    /* counter descriptors, or -1 */
+	int  slots[LINEAR_COUNTERS];  /* counter positions in the group, or -1 */
+} linear_profile_t;
+
+typedef struct linear_profile_record_s {
+	uint64_t  count;                              /* number of calls */
+	uint64_t  elements;                           /* total number of elements */
+	uint64_t  time;                               /* total time in nanoseconds */
+	uint64_t  histogram[LINEAR_PROFILE_BUCKETS];  /* calls by power of two size bound */
+	uint64_t  counted;                            /* number of calls with counters */
+	uint64_t  counters[LINEAR_COUNTERS];          /* total counter values */
+} linear_profile_record_t;
+
+typedef struct linear_trace_event_s {
+	char      name[LINEAR_TRACE_NAME];  /* function name */
+	uint64_t  begin;                    /* begin time in nanoseconds */
+	uint64_t  end;                      /* end time in nanoseconds */
+	uint64_t  tid;                      /* thread ID */
+	int       dims;                     /* number of dimensions, or -1 */
+	size_t    shape[2];                 /* dimensions of the first argument */
+	size_t    elements;                 /* number of elements */
+} linear_trace_event_t;
+
+typedef struct linear_parallel_task_s {
+	linear_parallel_function   f;       /* block function */
+	void                      *arg;     /* block function argument */
+	size_t                     start;   /* first row */
+	size_t                     end;     /* end row, exclusive */
+	int                        result;  /* block function result */
+} linear_parallel_task_t;
+
+
 /* vector */
 static void linear_push_vector(lua_State *L, size_t length, size_t inc, linear_data_t *data,
 		double *values);
@@ -52,8 +114,39 @@ static int linear_matrix_tostring(lua_State *L);
 static int linear_matrix_gc(lua_State *L);
 
 /* random */
-static void linear_seedrandomstate(uint64_t *s, uint64_t seed);
-static uint64_t *linear_randomstate(lua_State *L);
+static void linear_seedrandomstate(linear_random_t *r, uint64_t seed);
+static linear_random_t *linear_randomstate(lua_State *L);
+static void linear_jumprandomstate(linear_random_t *r, const uint64_t *jump);
+static int linear_rng_jump(lua_State *L);
+static int linear_rng_longjump(lua_State *L);
+static int linear_rng_seek(lua_State *L);
+static int linear_rng_tell(lua_State *L);
+static int linear_rng_clone(lua_State *L);
+static int linear_rng_tostring(lua_State *L);
+
+/* profile */
+static inline uint64_t linear_profile_clock(void);
+static linear_profile_t *linear_profilestate(lua_State *L);
+static void linear_profile_open(linear_profile_t *profile);
+static void linear_profile_close(linear_profile_t *profile);
+static int linear_profile_read(linear_profile_t *profile, uint64_t *counters);
+static const char *linear_profile_name(lua_State *L, lua_Debug *ar);
+static void linear_profile_record(lua_State *L, linear_profile_call_t *call, uint64_t time);
+static int linear_profile_gc(lua_State *L);
+static int linear_profile_function(lua_State *L);
+
+/* trace */
+static inline uint64_t linear_trace_tid(void);
+static void linear_trace_record(const char *name, linear_profile_call_t *call, uint64_t end);
+
+/* parallel */
+static void *linear_parallel_worker(void *arg);
+
+/* sort */
+static inline uint64_t linear_sortkey(double value, int descending);
+static inline double linear_sortvalue(uint64_t key, int descending);
+static void linear_sortkeys(uint64_t *keys, uint64_t *temp, size_t *index, size_t *indextemp,
+		size_t size);
 
 /* core functions */
 static int linear_vector(lua_State *L);
@@ -68,12 +161,35 @@ static int linear_sub(lua_State *L);
 static int linear_unwind(lua_State *L);
 static int linear_reshape(lua_State *L);
 static int linear_randomseed(lua_State *L);
+static int linear_rng(lua_State *L);
+static int linear_profile(lua_State *L);
+static int linear_trace(lua_State *L);
+static int linear_trace_dump(lua_State *L);
 #if LUA_VERSION_NUM < 502
 static int linear_ipairs(lua_State *L);
 #endif
 
 
+int linear_profiling = 0;
+static int linear_tracing = 0;  /* atomic */
+static linear_trace_event_t *linear_trace_events = NULL;
+static size_t linear_trace_capacity = 0;
+static size_t linear_trace_count = 0;
+static pthread_mutex_t linear_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
 static const char *const linear_orders[] = {"row", "col", NULL};
+static const char *const linear_generators[] = {"xoshiro", "philox", NULL};
+static const char *const linear_profile_counters[] = {"cycles", "instructions", "cachemisses",
+		"branchmisses"};
+#if LINEAR_USE_PERF && defined(__linux__)
+static const uint64_t linear_profile_events[] = {PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+#endif
+static const uint64_t linear_jump[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+		0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+static const uint64_t linear_longjump[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3,
+		0x77710069854ee241, 0x39109bb02acbe635};
 
 
 /*
@@ -115,7 +231,9 @@ void linear_checkargs (lua_State *L, int index, size_t size, linear_param_t *par
 			break;
 
 		case 'r':
-			args->r = linear_randomstate(L);
+			args->r = lua_isnoneornil(L, index) ? linear_randomstate(L)
+					: luaL_checkudata(L, index, LINEAR_RNG);
+			index++;
 			break;
 
 		default:
@@ -414,21 +532,23 @@ static int linear_matrix_gc (lua_State *L) {
  * random
  */
 
-static void linear_seedrandomstate (uint64_t *r, uint64_t seed) {
+static void linear_seedrandomstate (linear_random_t *r, uint64_t seed) {
 	int       i;
 	uint64_t  z;
 
 	/* source: SplitMix64; https://prng.di.unimi.it/ */
+	r->counter = 0;
 	for (i = 0; i < 4; i++) {
 		z = (seed += 0x9e3779b97f4a7c15);
 		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
 		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
-		r[i] = z ^ (z >> 31);
+		r->s[i] = z ^ (z >> 31);
 	}
+	r->key = r->stream = r->offset = 0;
 }
 
-static uint64_t *linear_randomstate (lua_State *L) {
-	uint64_t  *r;
+static linear_random_t *linear_randomstate (lua_State *L) {
+	linear_random_t  *r;
 
 	lua_getfield(L, LUA_REGISTRYINDEX, LINEAR_RANDOM);
 	r = lua_touserdata(L, -1);
@@ -436,35 +556,722 @@ static uint64_t *linear_randomstate (lua_State *L) {
 	return r;
 }
 
-double linear_random (uint64_t *r) {
-	uint64_t  result, t;
+static void linear_jumprandomstate (linear_random_t *r, const uint64_t *jump) {
+	int       i, b;
+	uint64_t  s[4];
+
+	/* source: xoshiro256+ jump functions; https://prng.di.unimi.it/ */
+	s[0] = s[1] = s[2] = s[3] = 0;
+	for (i = 0; i < 4; i++) {
+		for (b = 0; b < 64; b++) {
+			if (jump[i] & (uint64_t)1 << b) {
+				s[0] ^= r->s[0];
+				s[1] ^= r->s[1];
+				s[2] ^= r->s[2];
+				s[3] ^= r->s[3];
+			}
+			linear_randombits(r);
+		}
+	}
+	memcpy(r->s, s, sizeof(s));
+}
+
+static int linear_rng_jump (lua_State *L) {
+	linear_random_t  *r;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	if (r->counter) {
+		r->stream += 1;
+	} else {
+		linear_jumprandomstate(r, linear_jump);
+	}
+	return 0;
+}
+
+static int linear_rng_longjump (lua_State *L) {
+	linear_random_t  *r;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	if (r->counter) {
+		r->stream += (uint64_t)1 << 32;
+	} else {
+		linear_jumprandomstate(r, linear_longjump);
+	}
+	return 0;
+}
+
+static int linear_rng_seek (lua_State *L) {
+	lua_Integer       offset;
+	linear_random_t  *r;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	luaL_argcheck(L, r->counter, 1, "counter-based stream expected");
+	offset = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, offset >= 0, 2, "bad offset");
+	r->offset = (uint64_t)offset;
+	if (!lua_isnoneornil(L, 3)) {
+		r->stream = (uint64_t)luaL_checkinteger(L, 3);
+	}
+	return 0;
+}
+
+static int linear_rng_tell (lua_State *L) {
+	linear_random_t  *r;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	luaL_argcheck(L, r->counter, 1, "counter-based stream expected");
+	lua_pushinteger(L, (lua_Integer)r->offset);
+	return 1;
+}
+
+static int linear_rng_clone (lua_State *L) {
+	linear_random_t  *r, *c;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	c = lua_newuserdata(L, sizeof(linear_random_t));
+	memcpy(c, r, sizeof(linear_random_t));
+	luaL_getmetatable(L, LINEAR_RNG);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+static int linear_rng_tostring (lua_State *L) {
+	linear_random_t  *r;
+
+	r = luaL_checkudata(L, 1, LINEAR_RNG);
+	lua_pushfstring(L, LINEAR_RNG ": %p", r);
+	return 1;
+}
+
+void linear_randomblock (linear_random_t *r, uint32_t *block) {
+	int       i;
+	uint32_t  k0, k1, c0, c1, c2, c3;
+	uint64_t  p0, p1;
+
+	/* source: Philox4x32-10; Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3, 2011 */
+	c0 = (uint32_t)r->offset;
+	c1 = (uint32_t)(r->offset >> 32);
+	c2 = (uint32_t)r->stream;
+	c3 = (uint32_t)(r->stream >> 32);
+	k0 = (uint32_t)r->key;
+	k1 = (uint32_t)(r->key >> 32);
+	for (i = 0; i < 10; i++) {
+		p0 = (uint64_t)LINEAR_PHILOX_M0 * c0;
+		p1 = (uint64_t)LINEAR_PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t)p1;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t)p0;
+		k0 += LINEAR_PHILOX_W0;
+		k1 += LINEAR_PHILOX_W1;
+	}
+	block[0] = c0;
+	block[1] = c1;
+	block[2] = c2;
+	block[3] = c3;
+	r->offset++;
+}
+
+uint64_t linear_randombits (linear_random_t *r) {
+	uint64_t  result, t, *s;
+	uint32_t  block[4];
+
+	/* counter-based streams draw one block per value */
+	if (r->counter) {
+		linear_randomblock(r, block);
+		return (uint64_t)block[1] << 32 | block[0];
+	}
 
 	/* source: xoshiro256+; https://prng.di.unimi.it/ */
-	result = r[0] + r[3];
-	t = r[1] << 17;
-	r[2] ^= r[0];
-	r[3] ^= r[1];
-	r[1] ^= r[2];
-	r[0] ^= r[3];
-	r[2] ^= t;
-	r[3] = (r[3] << 45) | (r[3] >> (64 - 45));
-	return (result >> (64 - DBL_MANT_DIG)) * (1.0 / ((uint64_t)1 << DBL_MANT_DIG));  /* [0,1) */
+	s = r->s;
+	result = s[0] + s[3];
+	t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> (64 - 45));
+	return result;
+}
+
+double linear_random (linear_random_t *r) {
+	return (linear_randombits(r) >> (64 - DBL_MANT_DIG))
+			* (1.0 / ((uint64_t)1 << DBL_MANT_DIG));  /* [0,1) */
+}
+
+void linear_randomfill (linear_random_t *r, double *x, size_t incx, size_t size) {
+	int              k;
+	size_t           i, blocks;
+	uint64_t         s0[LINEAR_RANDOM_LANES], s1[LINEAR_RANDOM_LANES], s2[LINEAR_RANDOM_LANES],
+			s3[LINEAR_RANDOM_LANES], result[LINEAR_RANDOM_LANES], t;
+	linear_random_t  lane;
+
+	/* small fills and counter-based fills are serial */
+	if (size < LINEAR_RANDOM_LANESMIN || r->counter) {
+		for (i = 0; i < size; i++) {
+			x[i * incx] = linear_random(r);
+		}
+		return;
+	}
+
+	/* seed the lanes from the stream; jumps are left to the streams of the user */
+	for (k = 0; k < LINEAR_RANDOM_LANES; k++) {
+		linear_seedrandomstate(&lane, linear_randombits(r));
+		s0[k] = lane.s[0];
+		s1[k] = lane.s[1];
+		s2[k] = lane.s[2];
+		s3[k] = lane.s[3];
+	}
+
+	/* advance the lanes in lockstep; the loop over lanes vectorizes */
+	blocks = size / LINEAR_RANDOM_LANES;
+	for (i = 0; i < blocks; i++) {
+		for (k = 0; k < LINEAR_RANDOM_LANES; k++) {
+			result[k] = s0[k] + s3[k];
+			t = s1[k] << 17;
+			s2[k] ^= s0[k];
+			s3[k] ^= s1[k];
+			s1[k] ^= s2[k];
+			s0[k] ^= s3[k];
+			s2[k] ^= t;
+			s3[k] = (s3[k] << 45) | (s3[k] >> (64 - 45));
+		}
+		for (k = 0; k < LINEAR_RANDOM_LANES; k++) {
+			x[(i * LINEAR_RANDOM_LANES + k) * incx] = (result[k] >> (64 - DBL_MANT_DIG))
+					* (1.0 / ((uint64_t)1 << DBL_MANT_DIG));
+		}
+	}
+
+	/* fill the remainder from the stream */
+	for (i = blocks * LINEAR_RANDOM_LANES; i < size; i++) {
+		x[i * incx] = linear_random(r);
+	}
+}
+
+
+/*
+ * profile
+ */
+
+static inline uint64_t linear_profile_clock (void) {
+	struct timespec  ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static linear_profile_t *linear_profilestate (lua_State *L) {
+	linear_profile_t  *profile;
+
+	lua_getfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE);
+	profile = lua_touserdata(L, -1);
+	lua_pop(L, 1);
+	return profile;
+}
+
+static void linear_profile_open (linear_profile_t *profile) {
+#if LINEAR_USE_PERF && defined(__linux__)
+	int                     i, fd, slot;
+	struct perf_event_attr  attr;
+
+	/* open the available counters of the calling thread as a group */
+	if (profile->leader >= 0) {
+		return;
+	}
+	slot = 0;
+	for (i = 0; i < LINEAR_COUNTERS; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = linear_profile_events[i];
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = syscall(SYS_perf_event_open, &attr, 0, -1, profile->leader, PERF_FLAG_FD_CLOEXEC);
+		profile->fds[i] = fd;
+		if (fd >= 0) {
+			if (profile->leader < 0) {
+				profile->leader = fd;
+			}
+			profile->slots[i] = slot++;
+		}
+	}
+#else
+	(void)profile;
+#endif
+}
+
+static void linear_profile_close (linear_profile_t *profile) {
+	int  i;
+
+	/* close the members before the leader */
+	for (i = LINEAR_COUNTERS - 1; i >= 0; i--) {
+#if LINEAR_USE_PERF && defined(__linux__)
+		if (profile->fds[i] >= 0) {
+			close(profile->fds[i]);
+		}
+#endif
+		profile->fds[i] = -1;
+		profile->slots[i] = -1;
+	}
+	profile->leader = -1;
+}
+
+static int linear_profile_read (linear_profile_t *profile, uint64_t *counters) {
+#if LINEAR_USE_PERF && defined(__linux__)
+	int       i;
+	uint64_t  values[LINEAR_COUNTERS + 1];
+
+	/* a group read returns the number of counters followed by their values */
+	if (profile->leader < 0 || read(profile->leader, values, sizeof(values))
+			< (ssize_t)sizeof(uint64_t)) {
+		return 0;
+	}
+	for (i = 0; i < LINEAR_COUNTERS; i++) {
+		counters[i] = profile->slots[i] >= 0 && (uint64_t)profile->slots[i] < values[0]
+				? values[profile->slots[i] + 1] : 0;
+	}
+	return 1;
+#else
+	(void)profile;
+	(void)counters;
+	return 0;
+#endif
+}
+
+void linear_profile_start (lua_State *L, int index, linear_profile_call_t *call) {
+	linear_vector_t   *x;
+	linear_matrix_t   *X;
+	linear_sparse_t   *S;
+	linear_profile_t  *profile;
+
+	/* the size of the call is the shape of its first argument */
+	call->dims = -1;
+	call->shape[0] = call->shape[1] = 0;
+	call->elements = 0;
+	if (lua_type(L, index) == LUA_TNUMBER) {
+		call->dims = 0;
+		call->elements = 1;
+	} else if (lua_type(L, index) == LUA_TTABLE) {
+		call->dims = 1;
+		call->shape[0] = call->elements = lua_rawlen(L, index);
+	} else {
+		x = luaL_testudata(L, index, LINEAR_VECTOR);
+		X = x == NULL ? luaL_testudata(L, index, LINEAR_MATRIX) : NULL;
+		S = x == NULL && X == NULL ? luaL_testudata(L, index, LINEAR_SPARSE) : NULL;
+		if (x != NULL) {
+			call->dims = 1;
+			call->shape[0] = call->elements = x->length;
+		} else if (X != NULL) {
+			call->dims = 2;
+			call->shape[0] = X->rows;
+			call->shape[1] = X->cols;
+			call->elements = X->rows * X->cols;
+		} else if (S != NULL) {
+			call->dims = 2;
+			call->shape[0] = S->rows;
+			call->shape[1] = S->cols;
+			call->elements = S->nnz;
+		}
+	}
+
+	/* read the counters last, and the clock, so that the profile itself is not counted */
+	profile = linear_profilestate(L);
+	call->counted = profile != NULL && profile->enabled
+			&& linear_profile_read(profile, call->counters);
+	call->time = linear_profile_clock();
+}
+
+void linear_profile_stop (lua_State *L, linear_profile_call_t *call) {
+	int                i, tracing;
+	uint64_t           end, counters[LINEAR_COUNTERS];
+	lua_Debug          ar;
+	const char        *name;
+	linear_profile_t  *profile;
+
+	/* check the state, as profiling may be enabled in another state only */
+	end = linear_profile_clock();
+	profile = linear_profilestate(L);
+	if (call->counted) {
+		if (linear_profile_read(profile, counters)) {
+			for (i = 0; i < LINEAR_COUNTERS; i++) {
+				call->counters[i] = counters[i] - call->counters[i];
+			}
+		} else {
+			call->counted = 0;
+		}
+	}
+	tracing = __atomic_load_n(&linear_tracing, __ATOMIC_RELAXED);
+	if (!(profile != NULL && profile->enabled) && !tracing) {
+		return;
+	}
+
+	/* record under the name of the running function */
+	if (!lua_getstack(L, 0, &ar)) {
+		return;
+	}
+	name = linear_profile_name(L, &ar);
+	if (name != NULL) {
+		if (profile != NULL && profile->enabled) {
+			linear_profile_record(L, call, end - call->time);
+		}
+		if (tracing) {
+			linear_trace_record(name, call, end);
+		}
+	}
+	lua_pop(L, 1);
+}
+
+void linear_profile_setfuncs (lua_State *L, const luaL_Reg *functions) {
+	const luaL_Reg  *reg;
+
+	/* registers the functions as closures over the profiled entry point */
+	for (reg = functions; reg->name; reg++) {
+		lua_pushcfunction(L, reg->func);
+		lua_pushcclosure(L, linear_profile_function, 1);
+		lua_setfield(L, -2, reg->name);
+	}
+}
+
+static const char *linear_profile_name (lua_State *L, lua_Debug *ar) {
+	const char  *name;
+
+	/* pushes the name of the function, or nil */
+	lua_getfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_NAMES);
+	lua_getinfo(L, "f", ar);
+	lua_rawget(L, -2);
+	lua_remove(L, -2);
+	name = lua_type(L, -1) == LUA_TSTRING ? lua_tostring(L, -1) : NULL;
+	return name;
+}
+
+static void linear_profile_record (lua_State *L, linear_profile_call_t *call, uint64_t time) {
+	int                       i;
+	size_t                    bucket;
+	linear_profile_record_t  *record;
+
+	/* get or create the record; the name is on top of the stack */
+	lua_getfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_RECORDS);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	record = lua_touserdata(L, -1);
+	if (record == NULL) {
+		record = lua_newuserdata(L, sizeof(linear_profile_record_t));
+		memset(record, 0, sizeof(linear_profile_record_t));
+		lua_pushvalue(L, -4);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, -5);
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 2);
+
+	/* update */
+	bucket = 0;
+	while (bucket < LINEAR_PROFILE_BUCKETS - 1 && ((size_t)1 << bucket) < call->elements) {
+		bucket++;
+	}
+	record->count++;
+	record->elements += call->elements;
+	record->time += time;
+	record->histogram[bucket]++;
+	if (call->counted) {
+		record->counted++;
+		for (i = 0; i < LINEAR_COUNTERS; i++) {
+			record->counters[i] += call->counters[i];
+		}
+	}
+}
+
+static int linear_profile_gc (lua_State *L) {
+	linear_profile_t  *profile;
+
+	profile = lua_touserdata(L, 1);
+	if (profile->enabled) {
+		profile->enabled = 0;
+		__atomic_fetch_sub(&linear_profiling, 1, __ATOMIC_RELAXED);
+	}
+	linear_profile_close(profile);
+	return 0;
+}
+
+
+/*
+ * trace
+ */
+
+static inline uint64_t linear_trace_tid (void) {
+#if defined(__linux__)
+	return (uint64_t)syscall(SYS_gettid);
+#else
+	return 0;
+#endif
+}
+
+static int linear_profile_function (lua_State *L) {
+	int                    results;
+	lua_CFunction          f;
+	linear_profile_call_t  call;
+
+	/* the function is the upvalue */
+	f = lua_tocfunction(L, lua_upvalueindex(1));
+	if (!linear_isprofiling()) {
+		return f(L);
+	}
+	linear_profile_start(L, 1, &call);
+	results = f(L);
+	linear_profile_stop(L, &call);
+	return results;
+}
+
+static void linear_trace_record (const char *name, linear_profile_call_t *call, uint64_t end) {
+	uint64_t               tid;
+	linear_trace_event_t  *event;
+
+	/* the buffer is shared by all states, and overwrites its oldest events when full */
+	tid = linear_trace_tid();
+	pthread_mutex_lock(&linear_trace_mutex);
+	if (linear_trace_events != NULL) {
+		event = &linear_trace_events[linear_trace_count % linear_trace_capacity];
+		snprintf(event->name, LINEAR_TRACE_NAME, "%s", name);
+		event->begin = call->time;
+		event->end = end;
+		event->tid = tid;
+		event->dims = call->dims;
+		event->shape[0] = call->shape[0];
+		event->shape[1] = call->shape[1];
+		event->elements = call->elements;
+		linear_trace_count++;
+	}
+	pthread_mutex_unlock(&linear_trace_mutex);
 }
 
 
 /*
- * comparison
+ * parallel
  */
 
-int linear_comparison_handler (const void *a, const void *b) {
-	double  da, db;
+static void *linear_parallel_worker (void *arg) {
+	linear_parallel_task_t  *task;
+
+	task = arg;
+	task->result = task->f(task->arg, task->start, task->end);
+	return NULL;
+}
+
+int linear_parallel (linear_parallel_function f, void *arg, size_t count, const size_t *offsets,
+		size_t work) {
+	int                      started[LINEAR_PARALLEL_THREADS], result;
+	long                     cpus;
+	size_t                   threads, i, lower, upper, mid, target;
+	pthread_t                ids[LINEAR_PARALLEL_THREADS];
+	linear_parallel_task_t   tasks[LINEAR_PARALLEL_THREADS];
+
+	/* runs f over blocks of the rows, and returns the last non-zero result of a block, or 0;
+	   the amount of work decides whether threads are used; determine the number of threads */
+	threads = 1;
+	if (work >= LINEAR_PARALLEL_WORK) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpus > 1) {
+			threads = cpus < LINEAR_PARALLEL_THREADS ? (size_t)cpus : LINEAR_PARALLEL_THREADS;
+		}
+	}
+	if (threads > count) {
+		threads = count;
+	}
+	if (threads <= 1) {
+		return f(arg, 0, count);
+	}
+
+	/* partition the rows into blocks with similar work; offsets are cumulative, if provided */
+	for (i = 0; i < threads; i++) {
+		tasks[i].f = f;
+		tasks[i].arg = arg;
+		tasks[i].start = i > 0 ? tasks[i - 1].end : 0;
+		if (i == threads - 1) {
+			tasks[i].end = count;
+		} else if (offsets == NULL) {
+			tasks[i].end = count / threads * (i + 1);
+		} else {
+			target = work / threads * (i + 1);
+			lower = tasks[i].start;
+			upper = count;
+			while (lower < upper) {
+				mid = (lower + upper) / 2;
+				if (offsets[mid] < target) {
+					lower = mid + 1;
+				} else {
+					upper = mid;
+				}
+			}
+			tasks[i].end = lower;
+		}
+	}
 
-	da = *(const double *)a;
-	db = *(const double *)b;
-	return da < db ? -1 : (da > db ? 1 : 0);
+	/* run the blocks; a block whose thread cannot be started runs in the calling thread */
+	for (i = 1; i < threads; i++) {
+		started[i] = pthread_create(&ids[i], NULL, linear_parallel_worker, &tasks[i]) == 0;
+	}
+	linear_parallel_worker(&tasks[0]);
+	for (i = 1; i < threads; i++) {
+		if (started[i]) {
+			pthread_join(ids[i], NULL);
+		} else {
+			linear_parallel_worker(&tasks[i]);
+		}
+	}
+	result = 0;
+	for (i = 0; i < threads; i++) {
+		if (tasks[i].result != 0) {
+			result = tasks[i].result;
+		}
+	}
+	return result;
 }
 
 
+/*
+ * sort
+ */
+
+static inline uint64_t linear_sortkey (double value, int descending) {
+	uint64_t  bits, key;
+
+	/* maps the IEEE-754 bit pattern to an unsigned key of the same order; NaNs map last */
+	if (isnan(value)) {
+		return UINT64_MAX;
+	}
+	memcpy(&bits, &value, sizeof(bits));
+	key = bits & LINEAR_SORT_SIGN ? ~bits : bits ^ LINEAR_SORT_SIGN;
+	return descending ? ~key : key;
+}
+
+static inline double linear_sortvalue (uint64_t key, int descending) {
+	uint64_t  bits;
+	double    value;
+
+	if (key == UINT64_MAX) {
+		return NAN;
+	}
+	if (descending) {
+		key = ~key;
+	}
+	bits = key & LINEAR_SORT_SIGN ? key ^ LINEAR_SORT_SIGN : ~key;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void linear_sortkeys (uint64_t *keys, uint64_t *temp, size_t *index, size_t *indextemp,
+		size_t size) {
+	size_t     i, j, pass, passes, sum, count, counts[8][256], k, *indexorigin, *swapindex;
+	uint64_t  *origin, *swap, key;
+
+	/* stable sort of the keys, optionally carrying indexes; the result is in keys and index */
+	if (size <= LINEAR_SORT_INSERTION) {
+		for (i = 1; i < size; i++) {
+			key = keys[i];
+			k = index != NULL ? index[i] : 0;
+			for (j = i; j > 0 && keys[j - 1] > key; j--) {
+				keys[j] = keys[j - 1];
+				if (index != NULL) {
+					index[j] = index[j - 1];
+				}
+			}
+			keys[j] = key;
+			if (index != NULL) {
+				index[j] = k;
+			}
+		}
+		return;
+	}
+
+	/* LSD radix sort with 8-bit digits; passes with a single digit value are skipped */
+	memset(counts, 0, sizeof(counts));
+	for (i = 0; i < size; i++) {
+		key = keys[i];
+		for (pass = 0; pass < 8; pass++) {
+			counts[pass][(key >> (8 * pass)) & 0xff]++;
+		}
+	}
+	origin = keys;
+	indexorigin = index;
+	passes = 0;
+	for (pass = 0; pass < 8; pass++) {
+		if (counts[pass][(keys[0] >> (8 * pass)) & 0xff] == size) {
+			continue;
+		}
+		sum = 0;
+		for (j = 0; j < 256; j++) {
+			count = counts[pass][j];
+			counts[pass][j] = sum;
+			sum += count;
+		}
+		for (i = 0; i < size; i++) {
+			k = counts[pass][(keys[i] >> (8 * pass)) & 0xff]++;
+			temp[k] = keys[i];
+			if (index != NULL) {
+				indextemp[k] = index[i];
+			}
+		}
+		swap = keys;
+		keys = temp;
+		temp = swap;
+		if (index != NULL) {
+			swapindex = index;
+			index = indextemp;
+			indextemp = swapindex;
+		}
+		passes++;
+	}
+	if (passes % 2 != 0) {
+		memcpy(origin, keys, size * sizeof(uint64_t));
+		if (index != NULL) {
+			memcpy(indexorigin, index, size * sizeof(size_t));
+		}
+	}
+}
+
+int linear_radixsort (double *x, size_t incx, double *y, size_t incy, size_t size,
+		int descending) {
+	size_t     i;
+	uint64_t  *keys;
+
+	keys = malloc(2 * size * sizeof(uint64_t));
+	if (keys == NULL) {
+		return -1;
+	}
+	for (i = 0; i < size; i++) {
+		keys[i] = linear_sortkey(x[i * incx], descending);
+	}
+	linear_sortkeys(keys, keys + size, NULL, NULL, size);
+	for (i = 0; i < size; i++) {
+		y[i * incy] = linear_sortvalue(keys[i], descending);
+	}
+	free(keys);
+	return 0;
+}
+
+int linear_radixargsort (double *x, size_t incx, size_t *index, size_t size, int descending) {
+	size_t     i, *indextemp;
+	uint64_t  *keys;
+
+	keys = malloc(2 * size * sizeof(uint64_t));
+	indextemp = malloc(size * sizeof(size_t));
+	if (keys == NULL || indextemp == NULL) {
+		free(keys);
+		free(indextemp);
+		return -1;
+	}
+	for (i = 0; i < size; i++) {
+		keys[i] = linear_sortkey(x[i * incx], descending);
+		index[i] = i;
+	}
+	linear_sortkeys(keys, keys + size, index, indextemp, size);
+	free(keys);
+	free(indextemp);
+	return 0;
+}
+
 /*
  * core functions
  */
@@ -676,6 +1483,10 @@ static int linear_type (lua_State *L) {
 		lua_pushliteral(L, "vector");
 	} else if (luaL_testudata(L, 1, LINEAR_MATRIX) != NULL) {
 		lua_pushliteral(L, "matrix");
+	} else if (luaL_testudata(L, 1, LINEAR_SPARSE) != NULL) {
+		lua_pushliteral(L, "sparse");
+	} else if (luaL_testudata(L, 1, LINEAR_RNG) != NULL) {
+		lua_pushliteral(L, "rng");
 	} else {
 		lua_pushnil(L);
 	}
@@ -685,6 +1496,7 @@ static int linear_type (lua_State *L) {
 static int linear_size (lua_State *L) {
 	linear_vector_t  *x;
 	linear_matrix_t  *X;
+	linear_sparse_t  *S;
 
 	x = luaL_testudata(L, 1, LINEAR_VECTOR);
 	if (x != NULL) {
@@ -698,6 +1510,13 @@ static int linear_size (lua_State *L) {
 		lua_pushstring(L, linear_orders[X->order == CblasRowMajor ? 0 : 1]);
 		return 3;
 	}
+	S = luaL_testudata(L, 1, LINEAR_SPARSE);
+	if (S != NULL) {
+		lua_pushinteger(L, S->rows);
+		lua_pushinteger(L, S->cols);
+		lua_pushinteger(L, S->nnz);
+		return 3;
+	}
 	return linear_argerror(L, 1, 0);
 }
 
@@ -843,6 +1662,197 @@ static int linear_randomseed (lua_State *L) {
 	return 0;
 }
 
+static int linear_rng (lua_State *L) {
+	int               seeded, counter;
+	uint64_t          seed;
+	linear_random_t  *r, *s;
+
+	seeded = !lua_isnoneornil(L, 1);
+	seed = seeded ? (uint64_t)luaL_checkinteger(L, 1) : 0;
+	counter = luaL_checkoption(L, 2, "xoshiro", linear_generators) == 1;
+	r = lua_newuserdata(L, sizeof(linear_random_t));
+	s = linear_randomstate(L);
+	if (counter) {
+		/* the key is the seed, or drawn from the random state */
+		linear_seedrandomstate(r, 0);
+		r->counter = 1;
+		r->key = seeded ? seed : linear_randombits(s);
+	} else if (seeded) {
+		linear_seedrandomstate(r, seed);
+	} else {
+		/* split from the random state, which advances by 2^192 */
+		memcpy(r, s, sizeof(linear_random_t));
+		linear_jumprandomstate(s, linear_longjump);
+	}
+	luaL_getmetatable(L, LINEAR_RNG);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+static int linear_profile (lua_State *L) {
+	int                       enable, counters;
+	size_t                    i;
+	linear_profile_t         *profile;
+	linear_profile_record_t  *record;
+
+	profile = linear_profilestate(L);
+
+	/* enable or disable */
+	if (!lua_isnoneornil(L, 1)) {
+		luaL_checktype(L, 1, LUA_TBOOLEAN);
+		enable = lua_toboolean(L, 1);
+		counters = lua_toboolean(L, 2);
+		if (enable) {
+			/* start with fresh records */
+			lua_newtable(L);
+			lua_setfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_RECORDS);
+		}
+		/* the counters remain open when disabling, as the records refer to them */
+		if (enable) {
+			if (counters) {
+				linear_profile_open(profile);
+			} else {
+				linear_profile_close(profile);
+			}
+		}
+		if (enable != profile->enabled) {
+			profile->enabled = enable;
+			if (enable) {
+				__atomic_fetch_add(&linear_profiling, 1, __ATOMIC_RELAXED);
+			} else {
+				__atomic_fetch_sub(&linear_profiling, 1, __ATOMIC_RELAXED);
+			}
+		}
+		lua_pushboolean(L, profile->leader >= 0);
+		return 1;
+	}
+
+	/* return the records */
+	lua_newtable(L);
+	lua_getfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_RECORDS);
+	lua_pushnil(L);
+	while (lua_next(L, -2)) {
+		record = lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		lua_pushvalue(L, -1);
+		lua_createtable(L, 0, 4 + LINEAR_COUNTERS);
+		lua_pushinteger(L, record->count);
+		lua_setfield(L, -2, "count");
+		lua_pushinteger(L, record->elements);
+		lua_setfield(L, -2, "elements");
+		lua_pushnumber(L, record->time * 1E-9);
+		lua_setfield(L, -2, "time");
+		lua_newtable(L);
+		for (i = 0; i < LINEAR_PROFILE_BUCKETS; i++) {
+			if (record->histogram[i] > 0) {
+				lua_pushinteger(L, record->histogram[i]);
+				lua_rawseti(L, -2, (size_t)1 << i);
+			}
+		}
+		lua_setfield(L, -2, "histogram");
+		if (record->counted > 0) {
+			for (i = 0; i < LINEAR_COUNTERS; i++) {
+				if (profile->slots[i] >= 0) {
+					lua_pushinteger(L, record->counters[i]);
+					lua_setfield(L, -2, linear_profile_counters[i]);
+				}
+			}
+		}
+		lua_rawset(L, -5);
+	}
+	lua_pop(L, 1);
+	return 1;
+}
+
+static int linear_trace (lua_State *L) {
+	int                    enable;
+	lua_Integer            capacity;
+	linear_trace_event_t  *events;
+
+	luaL_checktype(L, 1, LUA_TBOOLEAN);
+	enable = lua_toboolean(L, 1);
+	capacity = luaL_optinteger(L, 2, LINEAR_TRACE_CAPACITY);
+	luaL_argcheck(L, capacity >= 1 && (size_t)capacity <= SIZE_MAX
+			/ sizeof(linear_trace_event_t), 2, "bad capacity");
+	pthread_mutex_lock(&linear_trace_mutex);
+	if (enable) {
+		/* start with a fresh buffer */
+		events = malloc(capacity * sizeof(linear_trace_event_t));
+		if (events == NULL) {
+			pthread_mutex_unlock(&linear_trace_mutex);
+			return luaL_error(L, "cannot allocate events");
+		}
+		free(linear_trace_events);
+		linear_trace_events = events;
+		linear_trace_capacity = capacity;
+		linear_trace_count = 0;
+	}
+	if (enable != linear_tracing) {
+		__atomic_store_n(&linear_tracing, enable, __ATOMIC_RELAXED);
+		if (enable) {
+			__atomic_fetch_add(&linear_profiling, 1, __ATOMIC_RELAXED);
+		} else {
+			__atomic_fetch_sub(&linear_profiling, 1, __ATOMIC_RELAXED);
+		}
+	}
+	pthread_mutex_unlock(&linear_trace_mutex);
+	return 0;
+}
+
+static int linear_trace_dump (lua_State *L) {
+	int                    pid, failed;
+	size_t                 i, n;
+	const char            *path;
+	FILE                  *f;
+	linear_trace_event_t  *event;
+
+	path = luaL_checkstring(L, 1);
+	f = fopen(path, "w");
+	if (f == NULL) {
+		return luaL_error(L, "cannot open '%s'", path);
+	}
+	pid = getpid();
+
+	/* write complete events in Chrome trace format, oldest first, with times in microseconds */
+	pthread_mutex_lock(&linear_trace_mutex);
+	n = linear_trace_count < linear_trace_capacity ? linear_trace_count
+			: linear_trace_capacity;
+	fprintf(f, "{\"traceEvents\":[");
+	for (i = 0; i < n; i++) {
+		event = &linear_trace_events[(linear_trace_count - n + i) % linear_trace_capacity];
+		fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"linear\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%llu,"
+				"\"args\":{\"elements\":%zu", i > 0 ? "," : "", event->name,
+				event->begin * 1E-3, (event->end - event->begin) * 1E-3, pid,
+				(unsigned long long)event->tid, event->elements);
+		switch (event->dims) {
+		case 0:
+			fprintf(f, ",\"shape\":[]");
+			break;
+
+		case 1:
+			fprintf(f, ",\"shape\":[%zu]", event->shape[0]);
+			break;
+
+		case 2:
+			fprintf(f, ",\"shape\":[%zu,%zu]", event->shape[0], event->shape[1]);
+			break;
+
+		default:
+			break;
+		}
+		fprintf(f, "}}");
+	}
+	fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+	pthread_mutex_unlock(&linear_trace_mutex);
+	failed = ferror(f);
+	if (fclose(f) != 0 || failed) {
+		return luaL_error(L, "cannot write '%s'", path);
+	}
+	lua_pushinteger(L, n);
+	return 1;
+}
+
 #if LUA_VERSION_NUM < 502
 static int linear_ipairs (lua_State *L) {
 	if (luaL_testudata(L, 1, LINEAR_VECTOR)) {
@@ -874,12 +1884,18 @@ int luaopen_linear (lua_State *L) {
 		{"unwind", linear_unwind},
 		{"reshape", linear_reshape},
 		{"randomseed", linear_randomseed},
+		{"rng", linear_rng},
+		{"profile", linear_profile},
+		{"trace", linear_trace},
+		{"trace_dump", linear_trace_dump},
 #if LUA_VERSION_NUM < 502
 		{ "ipairs", linear_ipairs },
 #endif
 		{ NULL, NULL }
 	};
-	uint64_t  *r;
+	int                i;
+	linear_random_t   *r;
+	linear_profile_t  *profile;
 
 	/* register functions */
 #if LUA_VERSION_NUM >= 502
@@ -891,6 +1907,7 @@ int luaopen_linear (lua_State *L) {
 	linear_open_unary(L);
 	linear_open_binary(L);
 	linear_open_program(L);
+	linear_open_sparse(L);
 
 	/* vector metatable */
 	luaL_newmetatable(L, LINEAR_VECTOR);
@@ -926,10 +1943,56 @@ int luaopen_linear (lua_State *L) {
 	lua_setfield(L, -2, "__gc");
 	lua_pop(L, 1);
 
+	/* random stream metatable */
+	luaL_newmetatable(L, LINEAR_RNG);
+	lua_newtable(L);
+	lua_pushcfunction(L, linear_rng_jump);
+	lua_setfield(L, -2, "jump");
+	lua_pushcfunction(L, linear_rng_longjump);
+	lua_setfield(L, -2, "longjump");
+	lua_pushcfunction(L, linear_rng_seek);
+	lua_setfield(L, -2, "seek");
+	lua_pushcfunction(L, linear_rng_tell);
+	lua_setfield(L, -2, "tell");
+	lua_pushcfunction(L, linear_rng_clone);
+	lua_setfield(L, -2, "clone");
+	lua_setfield(L, -2, "__index");
+	lua_pushcfunction(L, linear_rng_tostring);
+	lua_setfield(L, -2, "__tostring");
+	lua_pop(L, 1);
+
 	/* random state */
-	r = lua_newuserdata(L, 4 * sizeof(uint64_t));
+	r = lua_newuserdata(L, sizeof(linear_random_t));
 	linear_seedrandomstate(r, (uint64_t)time(NULL) ^ (uintptr_t)L);
 	lua_setfield(L, LUA_REGISTRYINDEX, LINEAR_RANDOM);
 
+	/* profile state */
+	profile = lua_newuserdata(L, sizeof(linear_profile_t));
+	profile->enabled = 0;
+	for (i = 0; i < LINEAR_COUNTERS; i++) {
+		profile->fds[i] = -1;
+	}
+	linear_profile_close(profile);
+	lua_newtable(L);
+	lua_pushcfunction(L, linear_profile_gc);
+	lua_setfield(L, -2, "__gc");
+	lua_setmetatable(L, -2);
+	lua_setfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE);
+	lua_newtable(L);
+	lua_setfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_RECORDS);
+
+	/* profile function names */
+	lua_newtable(L);
+	lua_pushnil(L);
+	while (lua_next(L, -3)) {
+		if (lua_type(L, -1) == LUA_TFUNCTION) {
+			lua_pushvalue(L, -2);
+			lua_rawset(L, -4);
+		} else {
+			lua_pop(L, 1);
+		}
+	}
+	lua_setfield(L, LUA_REGISTRYINDEX, LINEAR_PROFILE_NAMES);
+
 	return 1;
 }
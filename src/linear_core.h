@@ -11,13 +11,18 @@
 
 #include <stdint.h>
 #include <lua.h>
+#include <lauxlib.h>
 #include <cblas.h>
 
 
 #define LINEAR_VECTOR       "linear.vector"  /* vector metatable */
 #define LINEAR_MATRIX       "linear.matrix"  /* matrix metatable */
+#define LINEAR_SPARSE       "linear.sparse"  /* sparse matrix metatable */
 #define LINEAR_RANDOM       "linear.random"  /* random state */
+#define LINEAR_RNG          "linear.rng"     /* random stream metatable */
+#define LINEAR_PROFILE      "linear.profile" /* profile state */
 #define LINEAR_PARAMS_MAX   5                /* maximum number of extra parameters */
+#define LINEAR_COUNTERS     4                /* number of profile hardware counters */
 #define LINEAR_PARAMS_LAST  {'\0', {0.0}}    /* params termination */
 
 
@@ -41,6 +46,23 @@ typedef struct linear_matrix_s {
 	double         *values;  /* elements */
 } linear_matrix_t;
 
+typedef struct linear_sparse_s {
+	size_t   rows;    /* number of rows */
+	size_t   cols;    /* number of columns */
+	size_t   nnz;     /* number of stored elements */
+	size_t  *rowptr;  /* offsets of the rows; rows + 1 values */
+	size_t  *colind;  /* column indexes of the stored elements, ascending per row */
+	double  *values;  /* stored elements */
+} linear_sparse_t;
+
+typedef struct linear_random_s {
+	int       counter;  /* counter-based */
+	uint64_t  s[4];     /* xoshiro256+ state */
+	uint64_t  key;      /* counter-based key */
+	uint64_t  stream;   /* counter-based stream */
+	uint64_t  offset;   /* counter-based offset */
+} linear_random_t;
+
 typedef struct linear_param_s {
 	char                 type;   /* see linear_arg_u below */
 	union {
@@ -52,14 +74,28 @@ typedef struct linear_param_s {
 } linear_param_t;
 
 typedef union linear_arg {
-	lua_Number   n;  /* number */
-	lua_Integer  i;  /* integer */
-	int          e;  /* enum */
-	size_t       d;  /* ddof */
-	lua_State   *L;  /* Lua state */
-	uint64_t    *r;  /* random state */
+	lua_Number        n;  /* number */
+	lua_Integer       i;  /* integer */
+	int               e;  /* enum */
+	size_t            d;  /* ddof */
+	lua_State        *L;  /* Lua state */
+	linear_random_t  *r;  /* random state */
 } linear_arg_u;
 
+typedef struct linear_profile_call_s {
+	int       dims;                       /* number of dimensions, or -1 */
+	size_t    shape[2];                   /* dimensions of the first argument */
+	size_t    elements;                   /* number of elements */
+	uint64_t  time;                       /* start time */
+	int       counted;                    /* counters read */
+	uint64_t  counters[LINEAR_COUNTERS];  /* start counter values */
+} linear_profile_call_t;
+
+typedef int (*linear_parallel_function)(void *arg, size_t start, size_t end);
+
+
+extern int linear_profiling;  /* number of enabled profiles and traces; atomic */
+
 
 CBLAS_ORDER linear_checkorder(lua_State *L, int index);
 void linear_checkargs(lua_State *L, int index, size_t size, linear_param_t *params,
@@ -70,13 +106,27 @@ inline int linear_getfield(lua_State *L, int index, const char *key);
 #if LUA_VERSION_NUM < 502
 void *linear_testudata(lua_State *L, int index, const char *name);
 #endif
-double linear_random(uint64_t *r);
-int linear_comparison_handler(const void *a, const void *b);
+void linear_randomblock(linear_random_t *r, uint32_t *block);
+uint64_t linear_randombits(linear_random_t *r);
+double linear_random(linear_random_t *r);
+void linear_randomfill(linear_random_t *r, double *x, size_t incx, size_t size);
+void linear_profile_start(lua_State *L, int index, linear_profile_call_t *call);
+void linear_profile_stop(lua_State *L, linear_profile_call_t *call);
+void linear_profile_setfuncs(lua_State *L, const luaL_Reg *functions);
+int linear_parallel(linear_parallel_function f, void *arg, size_t count, const size_t *offsets,
+		size_t work);
+int linear_radixsort(double *x, size_t incx, double *y, size_t incy, size_t size,
+		int descending);
+int linear_radixargsort(double *x, size_t incx, size_t *index, size_t size, int descending);
 linear_vector_t *linear_create_vector(lua_State *L, size_t length);
 linear_matrix_t *linear_create_matrix(lua_State *L, size_t rows, size_t cols, CBLAS_ORDER order);
 int luaopen_linear(lua_State *L);
 
 
+static inline int linear_isprofiling (void) {
+	return __atomic_load_n(&linear_profiling, __ATOMIC_RELAXED);
+}
+
 inline int linear_rawgeti (lua_State *L, int index, int n) {
 #if LUA_VERSION_NUM >= 503
 	return lua_rawgeti(L, index, n);
@@ -6,6 +6,7 @@
 
 
 #include <stdlib.h>
+#include <float.h>
 #include <math.h>
 #include <lauxlib.h>
 #include "linear_core.h"
@@ -16,7 +17,16 @@
 #define luaL_testudata  linear_testudata
 #endif
 
+#define LINEAR_ZIGGURAT_LAYERS      128                  /* Ziggurat layers */
+#define LINEAR_ZIGGURAT_R           3.442619855899       /* Ziggurat tail start */
+#define LINEAR_ZIGGURAT_V           9.91256303526217e-3  /* Ziggurat layer area */
+#define LINEAR_POISSON_PTRS         10.0                 /* minimum Poisson mean of PTRS */
+#define LINEAR_BINOMIAL_BTRS        10.0                 /* minimum binomial mean of BTRS */
+#define LINEAR_NORMALQF_ITERATIONS  32                   /* maximum Newton iterations of normalqf */
 
+
+static int linear_elementary_call(lua_State *L, linear_elementary_function f,
+		linear_param_t *params);
 static void linear_inc_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
 static int linear_inc(lua_State *L);
 static void linear_scal_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
@@ -43,6 +53,8 @@ static void linear_clip_handler(size_t size, double *x, size_t incx, linear_arg_
 static int linear_clip(lua_State *L);
 static void linear_uniform_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
 static int linear_uniform(lua_State *L);
+static void linear_ziggurat_setup(void);
+static double linear_ziggurat(linear_random_t *r);
 static void linear_normal_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
 static int linear_normal(lua_State *L);
 static void linear_normalpdf_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
@@ -51,7 +63,23 @@ static void linear_normalcdf_handler(size_t size, double *x, size_t incx, linear
 static int linear_normalcdf(lua_State *L);
 static void linear_normalqf_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
 static int linear_normalqf(lua_State *L);
-
+static void linear_exponential_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_exponential(lua_State *L);
+static double linear_gammavariate(linear_random_t *r, double k);
+static void linear_gamma_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_gamma(lua_State *L);
+static void linear_beta_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_beta(lua_State *L);
+static void linear_poisson_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_poisson(lua_State *L);
+static void linear_binomial_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_binomial(lua_State *L);
+static void linear_studentt_handler(size_t size, double *x, size_t incx, linear_arg_u *args);
+static int linear_studentt(lua_State *L);
+
+
+static double linear_ziggurat_x[LINEAR_ZIGGURAT_LAYERS + 1];
+static double linear_ziggurat_f[LINEAR_ZIGGURAT_LAYERS + 1];
 
 static linear_param_t linear_params_none[] = {
 	LINEAR_PARAMS_LAST
@@ -74,11 +102,53 @@ static linear_param_t linear_params_mu_sigma[] = {
 	{'n', {.n = 1.0}},
 	LINEAR_PARAMS_LAST
 };
+static linear_param_t linear_params_lambda_random[] = {
+	{'n', {.n = 1.0}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
+static linear_param_t linear_params_k_theta_random[] = {
+	{'n', {.n = 1.0}},
+	{'n', {.n = 1.0}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
+static linear_param_t linear_params_alpha_beta_random[] = {
+	{'n', {.n = 1.0}},
+	{'n', {.n = 1.0}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
+static linear_param_t linear_params_n_p_random[] = {
+	{'i', {.i = 1}},
+	{'n', {.n = 0.5}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
+static linear_param_t linear_params_nu_random[] = {
+	{'n', {.n = 1.0}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
 
 static __thread lua_State  *linear_TL;
 
 
 int linear_elementary (lua_State *L, linear_elementary_function f, linear_param_t *params) {
+	int                    results;
+	linear_profile_call_t  call;
+
+	if (!linear_isprofiling()) {
+		return linear_elementary_call(L, f, params);
+	}
+	linear_profile_start(L, 1, &call);
+	results = linear_elementary_call(L, f, params);
+	linear_profile_stop(L, &call);
+	return results;
+}
+
+static int linear_elementary_call (lua_State *L, linear_elementary_function f,
+		linear_param_t *params) {
 	int               isnum;
 	size_t            i;
 	double            n;
@@ -366,45 +436,87 @@ static int linear_clip (lua_State *L) {
 }
 
 static void linear_uniform_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
-	size_t     i;
-	uint64_t  *r;
-
-	r = args[0].r;
-	for (i = 0; i < size; i++) {
-		*x = linear_random(r);
-		x += incx;
-	}
+	linear_randomfill(args[0].r, x, incx, size);
 }
 
 static int linear_uniform (lua_State *L) {
 	return linear_elementary(L, linear_uniform_handler, linear_params_random);
 }
 
-static void linear_normal_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
-	size_t     i;
-	double     u1, u2, r, s, c;
-	uint64_t  *rs;
-
-	rs = args[0].r;
-
-	/* Box-Muller transform */
-	for (i = 0; i < size - 1; i += 2) {
-		u1 = linear_random(rs);
-		u2 = linear_random(rs);
-		r = sqrt(-2.0 * log(1 - u1));
-		sincos(2 * M_PI * u2, &s, &c);
-		*x = r * c;
-		x += incx;
-		*x = r * s;
-		x += incx;
+static void linear_ziggurat_setup (void) {
+	int  i;
+
+	/* source: Marsaglia and Tsang, The Ziggurat Method for Generating Random Variables, 2000 */
+	linear_ziggurat_x[0] = LINEAR_ZIGGURAT_V / exp(-0.5 * LINEAR_ZIGGURAT_R * LINEAR_ZIGGURAT_R);
+	linear_ziggurat_x[1] = LINEAR_ZIGGURAT_R;
+	for (i = 2; i < LINEAR_ZIGGURAT_LAYERS; i++) {
+		linear_ziggurat_x[i] = sqrt(-2 * log(LINEAR_ZIGGURAT_V / linear_ziggurat_x[i - 1]
+				+ exp(-0.5 * linear_ziggurat_x[i - 1] * linear_ziggurat_x[i - 1])));
 	}
-	if (i < size) {
-		u1 = linear_random(rs);
-		u2 = linear_random(rs);
-		*x = sqrt(-2.0 * log(1 - u1)) * cos(2 * M_PI * u2);
+	linear_ziggurat_x[LINEAR_ZIGGURAT_LAYERS] = 0.0;
+	for (i = 0; i <= LINEAR_ZIGGURAT_LAYERS; i++) {
+		linear_ziggurat_f[i] = exp(-0.5 * linear_ziggurat_x[i] * linear_ziggurat_x[i]);
 	}
 }
 
+static double linear_ziggurat (linear_random_t *r) {
+	int       i;
+	double    u, z, a, b;
+	uint64_t  bits;
+
+	for (;;) {
+		/* layer and sign from bits 3 to 10, uniform from the upper 53 bits */
+		bits = linear_randombits(r);
+		i = (bits >> 3) & (LINEAR_ZIGGURAT_LAYERS - 1);
+		u = (bits >> 11) * (1.0 / ((uint64_t)1 << 53));
+		z = u * linear_ziggurat_x[i];
+		if (z < linear_ziggurat_x[i + 1]) {
+			/* rectangle */
+			return bits & 0x400 ? -z : z;
+		}
+		if (i == 0) {
+			/* tail */
+			do {
+				a = -log(1 - linear_random(r)) / LINEAR_ZIGGURAT_R;
+				b = -log(1 - linear_random(r));
+			} while (2 * b < a * a);
+			z = LINEAR_ZIGGURAT_R + a;
+			return bits & 0x400 ? -z : z;
+		}
+		/* wedge */
+		if (linear_ziggurat_f[i] + linear_random(r) * (linear_ziggurat_f[i + 1]
+				- linear_ziggurat_f[i]) < exp(-0.5 * z * z)) {
+			return bits & 0x400 ? -z : z;
+		}
+	}
+}
+
+void linear_normalfill (linear_random_t *r, double *x, size_t incx, size_t size) {
+	size_t    i;
+	double    u1, u2;
+	uint32_t  block[4];
+
+	if (r->counter) {
+		/* one block per value, so that each value depends only on its offset (Box-Muller) */
+		for (i = 0; i < size; i++) {
+			linear_randomblock(r, block);
+			u1 = (((uint64_t)block[1] << 32 | block[0]) >> 11) * (1.0 / ((uint64_t)1 << 53));
+			u2 = (((uint64_t)block[3] << 32 | block[2]) >> 11) * (1.0 / ((uint64_t)1 << 53));
+			*x = sqrt(-2.0 * log(1 - u1)) * cos(2 * M_PI * u2);
+			x += incx;
+		}
+		return;
+	}
+	for (i = 0; i < size; i++) {
+		*x = linear_ziggurat(r);
+		x += incx;
+	}
+}
+
+static void linear_normal_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	linear_normalfill(args[0].r, x, incx, size);
+}
+
 static int linear_normal (lua_State *L) {
 	return linear_elementary(L, linear_normal_handler, linear_params_random);
 }
@@ -443,6 +555,7 @@ static int linear_normalcdf (lua_State *L) {
 }
 
 static void linear_normalqf_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	int     iterations;
 	size_t  i;
 	double  mu, sigma, p, inverf, inverf_prev, f, fx;
 
@@ -457,14 +570,19 @@ static void linear_normalqf_handler (size_t size, double *x, size_t incx, linear
 		} else if (p == 1) {
 			inverf = INFINITY;
 		} else {
-			/* Newton-Raphson; ~ 4-8 iterations */
+			/* Newton-Raphson; ~ 4-8 iterations; erf rounding can leave the iteration
+			   oscillating by a few ulp, so it is bounded relatively and by count */
 			inverf = sqrt(-log((1 - p) * (1 + p))) * (p >= 0 ? 1 : -1);
+			iterations = 0;
 			do {
 				inverf_prev = inverf;
 				f = erf(inverf) - p;
 				fx = M_2_SQRTPI * exp(-(inverf * inverf));
 				inverf -= f / fx;
-			} while (fabs(inverf - inverf_prev) > 1e-16);
+				iterations++;
+			} while (fabs(inverf - inverf_prev) > 1e-16
+					&& fabs(inverf - inverf_prev) > 8 * DBL_EPSILON * fabs(inverf)
+					&& iterations < LINEAR_NORMALQF_ITERATIONS);
 		}
 		*x = mu + sigma * M_SQRT2 * inverf;
 		x += incx;
@@ -475,6 +593,249 @@ static int linear_normalqf (lua_State *L) {
 	return linear_elementary(L, linear_normalqf_handler, linear_params_mu_sigma);
 }
 
+static void linear_exponential_handler (size_t size, double *x, size_t incx,
+		linear_arg_u *args) {
+	size_t            i;
+	double            lambda;
+	linear_random_t  *r;
+
+	lambda = args[0].n;
+	r = args[1].r;
+	for (i = 0; i < size; i++) {
+		*x = -log(1 - linear_random(r)) / lambda;
+		x += incx;
+	}
+}
+
+static int linear_exponential (lua_State *L) {
+	luaL_argcheck(L, luaL_optnumber(L, 2, 1.0) > 0, 2, "bad lambda");
+	return linear_elementary(L, linear_exponential_handler, linear_params_lambda_random);
+}
+
+static double linear_gammavariate (linear_random_t *r, double k) {
+	double  d, c, z, v, u;
+
+	/* boost shapes below 1; source: Marsaglia and Tsang, A Simple Method for Generating Gamma
+	   Variables, 2000 */
+	if (k < 1) {
+		u = linear_random(r);
+		return linear_gammavariate(r, k + 1) * pow(1 - u, 1 / k);
+	}
+	d = k - 1.0 / 3;
+	c = 1 / sqrt(9 * d);
+	for (;;) {
+		do {
+			z = linear_ziggurat(r);
+			v = 1 + c * z;
+		} while (v <= 0);
+		v = v * v * v;
+		u = linear_random(r);
+		if (u < 1 - 0.0331 * z * z * z * z || log(u) < 0.5 * z * z + d * (1 - v + log(v))) {
+			return d * v;
+		}
+	}
+}
+
+static void linear_gamma_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	size_t            i;
+	double            k, theta;
+	linear_random_t  *r;
+
+	k = args[0].n;
+	theta = args[1].n;
+	r = args[2].r;
+	for (i = 0; i < size; i++) {
+		*x = linear_gammavariate(r, k) * theta;
+		x += incx;
+	}
+}
+
+static int linear_gamma (lua_State *L) {
+	luaL_argcheck(L, luaL_optnumber(L, 2, 1.0) > 0, 2, "bad k");
+	luaL_argcheck(L, luaL_optnumber(L, 3, 1.0) > 0, 3, "bad theta");
+	return linear_elementary(L, linear_gamma_handler, linear_params_k_theta_random);
+}
+
+static void linear_beta_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	size_t            i;
+	double            alpha, beta, a, b;
+	linear_random_t  *r;
+
+	alpha = args[0].n;
+	beta = args[1].n;
+	r = args[2].r;
+	for (i = 0; i < size; i++) {
+		a = linear_gammavariate(r, alpha);
+		b = linear_gammavariate(r, beta);
+		if (a + b > 0) {
+			*x = a / (a + b);
+		} else {
+			/* both variates underflowed; the distribution is concentrated at 0 and 1 */
+			*x = linear_random(r) * (alpha + beta) < alpha ? 1.0 : 0.0;
+		}
+		x += incx;
+	}
+}
+
+static int linear_beta (lua_State *L) {
+	luaL_argcheck(L, luaL_optnumber(L, 2, 1.0) > 0, 2, "bad alpha");
+	luaL_argcheck(L, luaL_optnumber(L, 3, 1.0) > 0, 3, "bad beta");
+	return linear_elementary(L, linear_beta_handler, linear_params_alpha_beta_random);
+}
+
+static void linear_poisson_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	size_t            i;
+	double            lambda, l, p, k, slam, loglam, a, b, invalpha, vr, u, v, us;
+	linear_random_t  *r;
+
+	lambda = args[0].n;
+	r = args[1].r;
+	if (lambda < LINEAR_POISSON_PTRS) {
+		/* multiplication method */
+		l = exp(-lambda);
+		for (i = 0; i < size; i++) {
+			k = 0;
+			p = linear_random(r);
+			while (p > l) {
+				p *= linear_random(r);
+				k++;
+			}
+			*x = k;
+			x += incx;
+		}
+		return;
+	}
+
+	/* source: Hoermann, The Transformed Rejection Method for Generating Poisson Random
+	   Variables, 1993 (PTRS) */
+	slam = sqrt(lambda);
+	loglam = log(lambda);
+	b = 0.931 + 2.53 * slam;
+	a = -0.059 + 0.02483 * b;
+	invalpha = 1.1239 + 1.1328 / (b - 3.4);
+	vr = 0.9277 - 3.6224 / (b - 2);
+	for (i = 0; i < size; i++) {
+		for (;;) {
+			u = linear_random(r) - 0.5;
+			v = linear_random(r);
+			us = 0.5 - fabs(u);
+			k = floor((2 * a / us + b) * u + lambda + 0.43);
+			if (us >= 0.07 && v <= vr) {
+				break;
+			}
+			if (k < 0 || (us < 0.013 && v > us)) {
+				continue;
+			}
+			if (log(v) + log(invalpha) - log(a / (us * us) + b)
+					<= -lambda + k * loglam - lgamma(k + 1)) {
+				break;
+			}
+		}
+		*x = k;
+		x += incx;
+	}
+}
+
+static int linear_poisson (lua_State *L) {
+	luaL_argcheck(L, luaL_optnumber(L, 2, 1.0) >= 0, 2, "bad lambda");
+	return linear_elementary(L, linear_poisson_handler, linear_params_lambda_random);
+}
+
+static void linear_binomial_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	int               flip;
+	size_t            i;
+	double            n, p, q, s, a, b, c, m, vr, alpha, logr, h, u, v, us, k, f;
+	linear_random_t  *r;
+
+	n = (double)args[0].i;
+	p = args[1].n;
+	r = args[2].r;
+	flip = p > 0.5;
+	if (flip) {
+		p = 1 - p;
+	}
+	q = 1 - p;
+	if (n * p < LINEAR_BINOMIAL_BTRS) {
+		/* inversion by sequential search */
+		s = p / q;
+		a = (n + 1) * s;
+		f = pow(q, n);
+		for (i = 0; i < size; i++) {
+			do {
+				u = linear_random(r);
+				v = f;
+				k = 0;
+				while (u > v && k < n) {
+					u -= v;
+					k++;
+					v *= a / k - s;
+				}
+			} while (u > v);
+			*x = flip ? n - k : k;
+			x += incx;
+		}
+		return;
+	}
+
+	/* source: Hoermann, The Generation of Binomial Random Variates, 1993 (BTRS) */
+	s = sqrt(n * p * q);
+	b = 1.15 + 2.53 * s;
+	a = -0.0873 + 0.0248 * b + 0.01 * p;
+	c = n * p + 0.5;
+	vr = 0.92 - 4.2 / b;
+	alpha = (2.83 + 5.1 / b) * s;
+	logr = log(p / q);
+	m = floor((n + 1) * p);
+	h = lgamma(m + 1) + lgamma(n - m + 1);
+	for (i = 0; i < size; i++) {
+		for (;;) {
+			u = linear_random(r) - 0.5;
+			v = linear_random(r);
+			us = 0.5 - fabs(u);
+			k = floor((2 * a / us + b) * u + c);
+			if (us >= 0.07 && v <= vr) {
+				break;
+			}
+			if (k < 0 || k > n) {
+				continue;
+			}
+			if (log(v * alpha / (a / (us * us) + b))
+					<= h - lgamma(k + 1) - lgamma(n - k + 1) + (k - m) * logr) {
+				break;
+			}
+		}
+		*x = flip ? n - k : k;
+		x += incx;
+	}
+}
+
+static int linear_binomial (lua_State *L) {
+	lua_Number  p;
+
+	luaL_argcheck(L, luaL_optinteger(L, 2, 1) >= 0, 2, "bad n");
+	p = luaL_optnumber(L, 3, 0.5);
+	luaL_argcheck(L, p >= 0 && p <= 1, 3, "bad p");
+	return linear_elementary(L, linear_binomial_handler, linear_params_n_p_random);
+}
+
+static void linear_studentt_handler (size_t size, double *x, size_t incx, linear_arg_u *args) {
+	size_t            i;
+	double            nu;
+	linear_random_t  *r;
+
+	nu = args[0].n;
+	r = args[1].r;
+	for (i = 0; i < size; i++) {
+		*x = linear_ziggurat(r) / sqrt(2 * linear_gammavariate(r, nu / 2) / nu);
+		x += incx;
+	}
+}
+
+static int linear_studentt (lua_State *L) {
+	luaL_argcheck(L, luaL_optnumber(L, 2, 1.0) > 0, 2, "bad nu");
+	return linear_elementary(L, linear_studentt_handler, linear_params_nu_random);
+}
+
 int linear_open_elementary (lua_State *L) {
 	static const luaL_Reg functions[] = {
 		{"inc", linear_inc},
@@ -494,8 +855,15 @@ int linear_open_elementary (lua_State *L) {
 		{"normalpdf", linear_normalpdf},
 		{"normalcdf", linear_normalcdf},
 		{"normalqf", linear_normalqf},
+		{"exponential", linear_exponential},
+		{"gamma", linear_gamma},
+		{"beta", linear_beta},
+		{"poisson", linear_poisson},
+		{"binomial", linear_binomial},
+		{"studentt", linear_studentt},
 		{NULL, NULL}
 	};
+	linear_ziggurat_setup();
 #if LUA_VERSION_NUM >= 502
 	luaL_setfuncs(L, functions, 0);
 #else
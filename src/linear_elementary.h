@@ -16,6 +16,7 @@ typedef void (*linear_elementary_function)(size_t size, double *x, size_t incx,
 
 
 int linear_elementary(lua_State *L, linear_elementary_function f, linear_param_t *params);
+void linear_normalfill(linear_random_t *r, double *x, size_t incx, size_t size);
 int linear_open_elementary(lua_State *L);
 
 
@@ -11,48 +11,158 @@
 #include <lapacke.h>
 #include <lauxlib.h>
 #include "linear_core.h"
+#include "linear_elementary.h"
 #include "linear_program.h"
 
 
 #if LUA_VERSION_NUM < 502
 #define lua_rawlen  lua_objlen
+#define luaL_testudata  linear_testudata
 #endif
 
 
+#define LINEAR_SPLINE_GRID        1E-9   /* relative spacing tolerance of uniform spline grids */
+#define LINEAR_PERMUTE_BLOCK      64     /* block size of permutation copies */
+#define LINEAR_SPLINE_CONST       0      /* spline polynomial forms; constant */
+#define LINEAR_SPLINE_LINEAR      1      /* linear */
+#define LINEAR_SPLINE_CUBIC       2      /* cubic */
+
+
 typedef struct linear_spline_s {
 	size_t   n;              /* number of polynomials */
+	size_t   m;              /* number of curves */
+	int      multiple;       /* curves from a matrix */
 	int      extrapolation;  /* extrapolation mode */
+	int      grid;           /* cut-in grid; 0 general, 1 uniform, 2 log-uniform */
+	double   origin;         /* grid origin; first cut-in, or its logarithm */
+	double   scale;          /* grid scale; reciprocal spacing, or reciprocal log spacing */
 	double  *x;              /* x cut-ins; n + 1 values */
-	double  *a;              /* constant coefficients; equals y; n + 1 values */
-	double  *b;              /* linear coefficients; n values */
-	double  *c;              /* quadratic coefficients; n values */
-	double  *d;              /* cubic coefficients; n values */
+	double  *a;              /* constant coefficients; equals y; (n + 1) * m values */
+	double  *b;              /* linear coefficients; n * m values */
+	double  *c;              /* quadratic coefficients; n * m values */
+	double  *d;              /* cubic coefficients; n * m values */
+	double  *s;              /* integrals from the first cut-in; (n + 1) * m values */
 } linear_spline_t;
 
+typedef struct linear_quantile_job_s {
+	size_t         length;  /* vector length */
+	const double  *x;       /* vector components */
+	size_t         incx;    /* component increment */
+	size_t         ldx;     /* vector increment */
+	const double  *r;       /* ranks */
+	size_t         nr;      /* number of ranks */
+	size_t         incr;    /* rank increment */
+	double        *q;       /* quantiles */
+	size_t         incq;    /* quantile increment */
+	size_t         ldq;     /* quantile vector increment */
+} linear_quantile_job_t;
+
+typedef struct linear_band_s {
+	char         kind;  /* 't' tridiagonal, 'g' general band, 'p' positive definite band */
+	char         uplo;  /* 'U' or 'L'; positive definite band */
+	size_t       n;     /* order */
+	size_t       kl;    /* number of subdiagonals */
+	size_t       ku;    /* number of superdiagonals */
+	size_t       ldab;  /* leading dimension of the band storage */
+	double      *ab;    /* band storage, or dl, d, du, du2; column major */
+	lapack_int  *ipiv;  /* pivot indexes */
+} linear_band_t;
+
 
 static inline CBLAS_TRANSPOSE linear_checktranspose(lua_State *L, int index);
 static inline char linear_lapacktranspose(CBLAS_TRANSPOSE transpose);
+static inline CBLAS_UPLO linear_checkuplo(lua_State *L, int index);
+static inline CBLAS_DIAG linear_checkdiag(lua_State *L, int index);
+static inline CBLAS_SIDE linear_checkside(lua_State *L, int index);
+static inline CBLAS_TRANSPOSE linear_ordertranspose(CBLAS_TRANSPOSE transpose, CBLAS_ORDER order,
+		CBLAS_ORDER target);
+static inline CBLAS_UPLO linear_orderuplo(CBLAS_UPLO uplo, CBLAS_ORDER order, CBLAS_ORDER target);
 static int linear_dot(lua_State *L);
 static int linear_ger(lua_State *L);
 static int linear_gemv(lua_State *L);
 static int linear_gemm(lua_State *L);
+static int linear_trmv(lua_State *L);
+static int linear_trsv(lua_State *L);
+static int linear_trmm(lua_State *L);
+static int linear_trsm(lua_State *L);
+static int linear_syr(lua_State *L);
+static int linear_symv(lua_State *L);
+static int linear_symm(lua_State *L);
+static int linear_syrk(lua_State *L);
+static int linear_syr2k(lua_State *L);
 static int linear_gesv(lua_State *L);
 static int linear_gels(lua_State *L);
+static linear_band_t *linear_checkband(lua_State *L, char kind, int uploindex);
+static int linear_factorband(linear_band_t *band);
+static int linear_solveband(lua_State *L, linear_band_t *band, int index);
+static int linear_gtsv(lua_State *L);
+static int linear_gbsv(lua_State *L);
+static int linear_pbsv(lua_State *L);
+static int linear_bandsolver(lua_State *L);
+static int linear_bandfactor(lua_State *L, char kind, int uploindex);
+static int linear_gttrf(lua_State *L);
+static int linear_gbtrf(lua_State *L);
+static int linear_pbtrf(lua_State *L);
 static int linear_inv(lua_State *L);
 static int linear_det(lua_State *L);
 static int linear_svd(lua_State *L);
+static int linear_rsvd(lua_State *L);
 static int linear_cov(lua_State *L);
 static int linear_corr(lua_State *L);
 static int linear_ranks(lua_State *L);
+static int linear_index_comparison(const void *a, const void *b);
+static void linear_select(double *s, size_t lower, size_t upper, size_t k);
+static void linear_multiselect(double *s, size_t lower, size_t upper, const size_t *k,
+		size_t klower, size_t kupper);
+static void linear_quantiles(double *s, size_t *k, size_t n, const double *x, size_t incx,
+		const double *r, size_t nr, size_t incr, double *q, size_t incq);
+static int linear_quantile_block(void *arg, size_t start, size_t end);
 static int linear_quantile(lua_State *L);
 static int linear_rank(lua_State *L);
+static int linear_sort(lua_State *L);
+static int linear_argsort(lua_State *L);
+static void linear_gather(const double *xv, size_t xrs, size_t xcs, double *yv, size_t yrs,
+		size_t ycs, const size_t *index, size_t rows, size_t cols);
+static int linear_permute(lua_State *L);
+static inline uint64_t linear_mulhi(uint64_t a, uint64_t b, uint64_t *lo);
+static inline size_t linear_bounded(linear_random_t *r, size_t s);
+static int linear_shuffle(lua_State *L);
+static int linear_sample(lua_State *L);
+static inline size_t linear_lowerbound(const double *s, size_t n, double q, int right);
+static int linear_searchsorted(lua_State *L);
+static inline int linear_topkbefore(double a, size_t ia, double b, size_t ib, int descending);
+static void linear_topkheap(double *hv, size_t *hi, size_t size, size_t root, int descending);
+static void linear_topkselect(const double *x, size_t incx, size_t n, size_t k, int descending,
+		double *hv, size_t *hi);
+static int linear_topk(lua_State *L);
+static size_t linear_splinesegment(linear_spline_t *spline, double x, size_t hint);
+static int linear_evalspline(linear_spline_t *spline, double x, int evaluation, size_t *hint,
+		double *y, size_t incy);
 static int linear_interpolant(lua_State *L);
 static int linear_spline(lua_State *L);
+static int linear_interp(lua_State *L);
 
 
 static const char *const linear_transposes[] = {"notrans", "trans", NULL};
+static const char *const linear_uplos[] = {"upper", "lower", NULL};
+static const char *const linear_diags[] = {"nonunit", "unit", NULL};
+static const char *const linear_sides[] = {"left", "right", NULL};
+static const char *const linear_drivers[] = {"gesvd", "gesdd", NULL};
 static const char *const linear_boundaries[] = {"not-a-knot", "clamped", "natural", NULL};
 static const char *const linear_extrapolations[] = {"none", "const", "linear", "cubic", NULL};
+static const char *const linear_directions[] = {"asc", "desc", NULL};
+static const char *const linear_searchsides[] = {"left", "right", NULL};
+static const char *const linear_evaluations[] = {"value", "derivative", "integral", NULL};
+static linear_param_t linear_params_random[] = {
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
+static linear_param_t linear_params_rsvd[] = {
+	{'i', {.i = 10}},
+	{'i', {.i = 2}},
+	{'r', {0.0}},
+	LINEAR_PARAMS_LAST
+};
 
 
 static inline CBLAS_TRANSPOSE linear_checktranspose (lua_State *L, int index) {
@@ -64,6 +174,35 @@ static inline char linear_lapacktranspose (CBLAS_TRANSPOSE transpose) {
 	return transpose == CblasNoTrans ? 'N' : 'T';
 }
 
+static inline CBLAS_UPLO linear_checkuplo (lua_State *L, int index) {
+	return luaL_checkoption(L, index, "upper", linear_uplos) == 0 ? CblasUpper : CblasLower;
+}
+
+static inline CBLAS_DIAG linear_checkdiag (lua_State *L, int index) {
+	return luaL_checkoption(L, index, "nonunit", linear_diags) == 0 ? CblasNonUnit : CblasUnit;
+}
+
+static inline CBLAS_SIDE linear_checkside (lua_State *L, int index) {
+	return luaL_checkoption(L, index, "left", linear_sides) == 0 ? CblasLeft : CblasRight;
+}
+
+static inline CBLAS_TRANSPOSE linear_ordertranspose (CBLAS_TRANSPOSE transpose,
+		CBLAS_ORDER order, CBLAS_ORDER target) {
+	/* a matrix read in the opposite order is its transpose */
+	if (order == target) {
+		return transpose;
+	}
+	return transpose == CblasNoTrans ? CblasTrans : CblasNoTrans;
+}
+
+static inline CBLAS_UPLO linear_orderuplo (CBLAS_UPLO uplo, CBLAS_ORDER order,
+		CBLAS_ORDER target) {
+	if (order == target) {
+		return uplo;
+	}
+	return uplo == CblasUpper ? CblasLower : CblasUpper;
+}
+
 static int linear_dot (lua_State *L) {
 	linear_vector_t  *x, *y;
 
@@ -118,19 +257,209 @@ static int linear_gemm (lua_State *L) {
 
 	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
 	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
-	luaL_argcheck(L, B->order == A->order, 2, "order mismatch");
 	C = luaL_checkudata(L, 3, LINEAR_MATRIX);
-	luaL_argcheck(L, C->order == A->order, 3, "order mismatch");
 	ta = linear_checktranspose(L, 4);
 	tb = linear_checktranspose(L, 5);
 	m = ta == CblasNoTrans ? A->rows : A->cols;
 	n = tb == CblasNoTrans ? B->cols : B->rows;
 	k = ta == CblasNoTrans ? A->cols : A->rows;
 	luaL_argcheck(L, k == (tb == CblasNoTrans ? B->rows : B->cols), 2, "dimension mismatch");
+	luaL_argcheck(L, C->rows == m && C->cols == n, 3, "dimension mismatch");
+	alpha = luaL_optnumber(L, 6, 1.0);
+	beta = luaL_optnumber(L, 7, 0.0);
+	cblas_dgemm(C->order, linear_ordertranspose(ta, A->order, C->order),
+			linear_ordertranspose(tb, B->order, C->order), m, n, k, alpha, A->values, A->ld,
+			B->values, B->ld, beta, C->values, C->ld);
+	return 0;
+}
+
+static int linear_trmv (lua_State *L) {
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	CBLAS_DIAG        diag;
+	linear_matrix_t  *A;
+	linear_vector_t  *x;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	x = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	luaL_argcheck(L, x->length == A->rows, 2, "dimension mismatch");
+	uplo = linear_checkuplo(L, 3);
+	ta = linear_checktranspose(L, 4);
+	diag = linear_checkdiag(L, 5);
+	cblas_dtrmv(A->order, uplo, ta, diag, A->rows, A->values, A->ld, x->values, x->inc);
+	return 0;
+}
+
+static int linear_trsv (lua_State *L) {
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	CBLAS_DIAG        diag;
+	linear_matrix_t  *A;
+	linear_vector_t  *x;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	x = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	luaL_argcheck(L, x->length == A->rows, 2, "dimension mismatch");
+	uplo = linear_checkuplo(L, 3);
+	ta = linear_checktranspose(L, 4);
+	diag = linear_checkdiag(L, 5);
+	cblas_dtrsv(A->order, uplo, ta, diag, A->rows, A->values, A->ld, x->values, x->inc);
+	return 0;
+}
+
+static int linear_trmm (lua_State *L) {
+	double            alpha;
+	CBLAS_SIDE        side;
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	CBLAS_DIAG        diag;
+	linear_matrix_t  *A, *B;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	side = linear_checkside(L, 3);
+	luaL_argcheck(L, (side == CblasLeft ? B->rows : B->cols) == A->rows, 2,
+			"dimension mismatch");
+	uplo = linear_checkuplo(L, 4);
+	ta = linear_checktranspose(L, 5);
+	diag = linear_checkdiag(L, 6);
+	alpha = luaL_optnumber(L, 7, 1.0);
+	cblas_dtrmm(B->order, side, linear_orderuplo(uplo, A->order, B->order),
+			linear_ordertranspose(ta, A->order, B->order), diag, B->rows, B->cols, alpha,
+			A->values, A->ld, B->values, B->ld);
+	return 0;
+}
+
+static int linear_trsm (lua_State *L) {
+	double            alpha;
+	CBLAS_SIDE        side;
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	CBLAS_DIAG        diag;
+	linear_matrix_t  *A, *B;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	side = linear_checkside(L, 3);
+	luaL_argcheck(L, (side == CblasLeft ? B->rows : B->cols) == A->rows, 2,
+			"dimension mismatch");
+	uplo = linear_checkuplo(L, 4);
+	ta = linear_checktranspose(L, 5);
+	diag = linear_checkdiag(L, 6);
+	alpha = luaL_optnumber(L, 7, 1.0);
+	cblas_dtrsm(B->order, side, linear_orderuplo(uplo, A->order, B->order),
+			linear_ordertranspose(ta, A->order, B->order), diag, B->rows, B->cols, alpha,
+			A->values, A->ld, B->values, B->ld);
+	return 0;
+}
+
+static int linear_syr (lua_State *L) {
+	double            alpha;
+	CBLAS_UPLO        uplo;
+	linear_vector_t  *x;
+	linear_matrix_t  *A;
+
+	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
+	A = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 2, "not square");
+	luaL_argcheck(L, A->rows == x->length, 2, "dimension mismatch");
+	uplo = linear_checkuplo(L, 3);
+	alpha = luaL_optnumber(L, 4, 1.0);
+	cblas_dsyr(A->order, uplo, A->rows, alpha, x->values, x->inc, A->values, A->ld);
+	return 0;
+}
+
+static int linear_symv (lua_State *L) {
+	double            alpha, beta;
+	CBLAS_UPLO        uplo;
+	linear_matrix_t  *A;
+	linear_vector_t  *x, *y;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	x = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	luaL_argcheck(L, x->length == A->rows, 2, "dimension mismatch");
+	y = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	luaL_argcheck(L, y->length == A->rows, 3, "dimension mismatch");
+	uplo = linear_checkuplo(L, 4);
+	alpha = luaL_optnumber(L, 5, 1.0);
+	beta = luaL_optnumber(L, 6, 0.0);
+	cblas_dsymv(A->order, uplo, A->rows, alpha, A->values, A->ld, x->values, x->inc, beta,
+			y->values, y->inc);
+	return 0;
+}
+
+static int linear_symm (lua_State *L) {
+	double            alpha, beta;
+	CBLAS_SIDE        side;
+	CBLAS_UPLO        uplo;
+	linear_matrix_t  *A, *B, *C;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	luaL_argcheck(L, A->rows == A->cols, 1, "not square");
+	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	C = luaL_checkudata(L, 3, LINEAR_MATRIX);
+	luaL_argcheck(L, C->order == B->order, 3, "order mismatch");
+	side = linear_checkside(L, 4);
+	luaL_argcheck(L, (side == CblasLeft ? B->rows : B->cols) == A->rows, 2,
+			"dimension mismatch");
+	luaL_argcheck(L, C->rows == B->rows && C->cols == B->cols, 3, "dimension mismatch");
+	uplo = linear_checkuplo(L, 5);
+	alpha = luaL_optnumber(L, 6, 1.0);
+	beta = luaL_optnumber(L, 7, 0.0);
+	cblas_dsymm(C->order, side, linear_orderuplo(uplo, A->order, C->order), C->rows, C->cols,
+			alpha, A->values, A->ld, B->values, B->ld, beta, C->values, C->ld);
+	return 0;
+}
+
+static int linear_syrk (lua_State *L) {
+	size_t            n, k;
+	double            alpha, beta;
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	linear_matrix_t  *A, *C;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	C = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	luaL_argcheck(L, C->rows == C->cols, 2, "not square");
+	uplo = linear_checkuplo(L, 3);
+	ta = linear_checktranspose(L, 4);
+	n = ta == CblasNoTrans ? A->rows : A->cols;
+	k = ta == CblasNoTrans ? A->cols : A->rows;
+	luaL_argcheck(L, C->rows == n, 2, "dimension mismatch");
+	alpha = luaL_optnumber(L, 5, 1.0);
+	beta = luaL_optnumber(L, 6, 0.0);
+	cblas_dsyrk(C->order, uplo, linear_ordertranspose(ta, A->order, C->order), n, k, alpha,
+			A->values, A->ld, beta, C->values, C->ld);
+	return 0;
+}
+
+static int linear_syr2k (lua_State *L) {
+	size_t            n, k;
+	double            alpha, beta;
+	CBLAS_UPLO        uplo;
+	CBLAS_TRANSPOSE   ta;
+	linear_matrix_t  *A, *B, *C;
+
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	luaL_argcheck(L, B->order == A->order, 2, "order mismatch");
+	luaL_argcheck(L, B->rows == A->rows && B->cols == A->cols, 2, "dimension mismatch");
+	C = luaL_checkudata(L, 3, LINEAR_MATRIX);
+	luaL_argcheck(L, C->rows == C->cols, 3, "not square");
+	uplo = linear_checkuplo(L, 4);
+	ta = linear_checktranspose(L, 5);
+	n = ta == CblasNoTrans ? A->rows : A->cols;
+	k = ta == CblasNoTrans ? A->cols : A->rows;
+	luaL_argcheck(L, C->rows == n, 3, "dimension mismatch");
 	alpha = luaL_optnumber(L, 6, 1.0);
 	beta = luaL_optnumber(L, 7, 0.0);
-	cblas_dgemm(A->order, ta, tb, m, n, k, alpha, A->values, A->ld, B->values, B->ld, beta,
-			C->values, C->ld);
+	cblas_dsyr2k(C->order, uplo, linear_ordertranspose(ta, A->order, C->order), n, k, alpha,
+			A->values, A->ld, B->values, B->ld, beta, C->values, C->ld);
 	return 0;
 }
 
@@ -177,6 +506,281 @@ static int linear_gels (lua_State *L) {
 	return 1;
 }
 
+static linear_band_t *linear_checkband (lua_State *L, char kind, int uploindex) {
+	char              uplo;
+	size_t            i, j, n, kl, ku, ldab, size;
+	linear_vector_t  *dl, *d, *du;
+	linear_matrix_t  *AB;
+	linear_band_t    *band;
+
+	/* process arguments */
+	dl = d = du = NULL;
+	AB = NULL;
+	uplo = 'U';
+	kl = ku = 0;
+	switch (kind) {
+	case 't':
+		dl = luaL_checkudata(L, 1, LINEAR_VECTOR);
+		d = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		du = luaL_checkudata(L, 3, LINEAR_VECTOR);
+		luaL_argcheck(L, d->length >= 2, 2, "bad dimension");
+		luaL_argcheck(L, dl->length == d->length - 1, 1, "dimension mismatch");
+		luaL_argcheck(L, du->length == d->length - 1, 3, "dimension mismatch");
+		n = d->length;
+		kl = ku = 1;
+		ldab = 0;
+		size = 4 * n;
+		break;
+
+	case 'g':
+		AB = luaL_checkudata(L, 1, LINEAR_MATRIX);
+		kl = luaL_checkinteger(L, 2);
+		luaL_argcheck(L, kl < AB->rows, 2, "bad number of subdiagonals");
+		n = AB->cols;
+		ku = AB->rows - 1 - kl;
+		ldab = 2 * kl + ku + 1;
+		size = ldab * n;
+		break;
+
+	case 'p':
+		AB = luaL_checkudata(L, 1, LINEAR_MATRIX);
+		uplo = linear_checkuplo(L, uploindex) == CblasUpper ? 'U' : 'L';
+		n = AB->cols;
+		kl = ku = AB->rows - 1;
+		ldab = AB->rows;
+		size = ldab * n;
+		break;
+
+	default:
+		luaL_error(L, "internal error");
+		return NULL;  /* not reached */
+	}
+
+	/* create band */
+	band = lua_newuserdata(L, sizeof(linear_band_t) + size * sizeof(double)
+			+ (kind != 'p' ? n * sizeof(lapack_int) : 0));
+	band->kind = kind;
+	band->uplo = uplo;
+	band->n = n;
+	band->kl = kl;
+	band->ku = ku;
+	band->ldab = ldab;
+	band->ab = (double *)((char *)band + sizeof(linear_band_t));
+	band->ipiv = kind != 'p' ? (lapack_int *)(band->ab + size) : NULL;
+
+	/* copy the band storage */
+	switch (kind) {
+	case 't':
+		for (i = 0; i < n - 1; i++) {
+			band->ab[i] = dl->values[i * dl->inc];
+			band->ab[n - 1 + i] = du->values[i * du->inc];
+		}
+		for (i = 0; i < n; i++) {
+			band->ab[2 * (n - 1) + i] = d->values[i * d->inc];
+		}
+		break;
+
+	case 'g':
+		memset(band->ab, 0, size * sizeof(double));
+		/* FALLTHROUGH */
+	case 'p':
+		for (j = 0; j < n; j++) {
+			for (i = 0; i < AB->rows; i++) {
+				band->ab[j * ldab + (kind == 'g' ? kl : 0) + i] = AB->order
+						== CblasRowMajor ? AB->values[i * AB->ld + j]
+						: AB->values[j * AB->ld + i];
+			}
+		}
+		break;
+	}
+	return band;
+}
+
+static int linear_factorband (linear_band_t *band) {
+	double  *dl, *d, *du, *du2;
+
+	switch (band->kind) {
+	case 't':
+		dl = band->ab;
+		du = dl + (band->n - 1);
+		d = du + (band->n - 1);
+		du2 = d + band->n;
+		return LAPACKE_dgttrf(band->n, dl, d, du, du2, band->ipiv);
+
+	case 'g':
+		return LAPACKE_dgbtrf(LAPACK_COL_MAJOR, band->n, band->n, band->kl, band->ku,
+				band->ab, band->ldab, band->ipiv);
+
+	case 'p':
+		return LAPACKE_dpbtrf(LAPACK_COL_MAJOR, band->uplo, band->n, band->kl, band->ab,
+				band->ldab);
+	}
+	return -1;
+}
+
+static int linear_solveband (lua_State *L, linear_band_t *band, int index) {
+	double           *values, *b, *dl, *d, *du, *du2;
+	size_t            i, j, nrhs, rs, cs, ldb;
+	lapack_int        result;
+	linear_vector_t  *x;
+	linear_matrix_t  *X;
+
+	/* check and gather the right hand sides */
+	x = luaL_testudata(L, index, LINEAR_VECTOR);
+	if (x != NULL) {
+		luaL_argcheck(L, x->length == band->n, index, "dimension mismatch");
+		nrhs = 1;
+		rs = x->inc;
+		cs = 0;
+		ldb = band->n;
+		values = x->values;
+	} else {
+		X = luaL_testudata(L, index, LINEAR_MATRIX);
+		if (X == NULL) {
+			return linear_argerror(L, index, 0);
+		}
+		luaL_argcheck(L, X->rows == band->n, index, "dimension mismatch");
+		nrhs = X->cols;
+		rs = X->order == CblasRowMajor ? X->ld : 1;
+		cs = X->order == CblasRowMajor ? 1 : X->ld;
+		ldb = X->ld;
+		values = X->values;
+	}
+	b = values;
+	if (rs != 1) {
+		b = malloc(band->n * nrhs * sizeof(double));
+		if (b == NULL) {
+			return luaL_error(L, "cannot allocate values");
+		}
+		ldb = band->n;
+		for (j = 0; j < nrhs; j++) {
+			for (i = 0; i < band->n; i++) {
+				b[j * band->n + i] = values[i * rs + j * cs];
+			}
+		}
+	}
+
+	/* solve */
+	switch (band->kind) {
+	case 't':
+		dl = band->ab;
+		du = dl + (band->n - 1);
+		d = du + (band->n - 1);
+		du2 = d + band->n;
+		result = LAPACKE_dgttrs(LAPACK_COL_MAJOR, 'N', band->n, nrhs, dl, d, du, du2,
+				band->ipiv, b, ldb);
+		break;
+
+	case 'g':
+		result = LAPACKE_dgbtrs(LAPACK_COL_MAJOR, 'N', band->n, band->kl, band->ku, nrhs,
+				band->ab, band->ldab, band->ipiv, b, ldb);
+		break;
+
+	case 'p':
+		result = LAPACKE_dpbtrs(LAPACK_COL_MAJOR, band->uplo, band->n, band->kl, nrhs,
+				band->ab, band->ldab, b, ldb);
+		break;
+
+	default:
+		result = -1;
+	}
+
+	/* scatter the solutions */
+	if (rs != 1) {
+		for (j = 0; j < nrhs; j++) {
+			for (i = 0; i < band->n; i++) {
+				values[i * rs + j * cs] = b[j * band->n + i];
+			}
+		}
+		free(b);
+	}
+	if (result != 0) {
+		return luaL_error(L, "internal error");
+	}
+	return 0;
+}
+
+static int linear_gtsv (lua_State *L) {
+	int             result;
+	linear_band_t  *band;
+
+	band = linear_checkband(L, 't', 0);
+	result = linear_factorband(band);
+	if (result < 0) {
+		return luaL_error(L, "internal error");
+	}
+	if (result == 0) {
+		linear_solveband(L, band, 4);
+	}
+	lua_pushboolean(L, result == 0);
+	return 1;
+}
+
+static int linear_gbsv (lua_State *L) {
+	int             result;
+	linear_band_t  *band;
+
+	band = linear_checkband(L, 'g', 0);
+	result = linear_factorband(band);
+	if (result < 0) {
+		return luaL_error(L, "internal error");
+	}
+	if (result == 0) {
+		linear_solveband(L, band, 3);
+	}
+	lua_pushboolean(L, result == 0);
+	return 1;
+}
+
+static int linear_pbsv (lua_State *L) {
+	int             result;
+	linear_band_t  *band;
+
+	band = linear_checkband(L, 'p', 3);
+	result = linear_factorband(band);
+	if (result < 0) {
+		return luaL_error(L, "internal error");
+	}
+	if (result == 0) {
+		linear_solveband(L, band, 2);
+	}
+	lua_pushboolean(L, result == 0);
+	return 1;
+}
+
+static int linear_bandsolver (lua_State *L) {
+	return linear_solveband(L, lua_touserdata(L, lua_upvalueindex(1)), 1);
+}
+
+static int linear_bandfactor (lua_State *L, char kind, int uploindex) {
+	int             result;
+	linear_band_t  *band;
+
+	band = linear_checkband(L, kind, uploindex);
+	result = linear_factorband(band);
+	if (result < 0) {
+		return luaL_error(L, "internal error");
+	}
+	if (result > 0) {
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_pushcclosure(L, linear_bandsolver, 1);
+	return 1;
+}
+
+static int linear_gttrf (lua_State *L) {
+	return linear_bandfactor(L, 't', 0);
+}
+
+static int linear_gbtrf (lua_State *L) {
+	return linear_bandfactor(L, 'g', 0);
+}
+
+static int linear_pbtrf (lua_State *L) {
+	return linear_bandfactor(L, 'p', 2);
+}
+
 static int linear_inv (lua_State *L) {
 	lapack_int       *ipiv, result;
 	linear_matrix_t  *A;
@@ -263,7 +867,7 @@ static int linear_det (lua_State *L) {
 }
 
 static int linear_svd (lua_State *L) {
-	int               full;
+	int               full, driver;
 	size_t            min, ns;
 	double           *superb;
 	lapack_int       *isuperb, nsout, result;
@@ -276,8 +880,9 @@ static int linear_svd (lua_State *L) {
 	s = luaL_checkudata(L, 3, LINEAR_VECTOR);
 	VT = luaL_checkudata(L, 4, LINEAR_MATRIX);
 	min = A->cols < A->rows ? A->cols : A->rows;
-	full = lua_gettop(L) == 4;
+	full = lua_isnoneornil(L, 5);
 	ns = full ? min : (size_t)luaL_checkinteger(L, 5);
+	driver = luaL_checkoption(L, 6, "gesvd", linear_drivers);
 	luaL_argcheck(L, U->order == A->order, 2, "order mismatch");
 	luaL_argcheck(L, U->rows == A->rows && U->cols == (full ? A->rows : ns), 2,
 			"dimension mismatch");
@@ -287,9 +892,14 @@ static int linear_svd (lua_State *L) {
 	luaL_argcheck(L, VT->rows == (full ? A->cols : ns) && VT->cols == A->cols, 4,
 			"dimension mismatch");
 	luaL_argcheck(L, ns >= 1 && ns <= min, 5, "dimension mismatch");
+	luaL_argcheck(L, driver == 0 || ns == min, 6, "bad driver");
 
 	/* invoke subprogram */
-	if (ns == min) {
+	if (driver == 1) {
+		/* divide-and-conquer */
+		result = LAPACKE_dgesdd(A->order, full ? 'A' : 'S', A->rows, A->cols, A->values,
+				A->ld, s->values, U->values, U->ld, VT->values, VT->ld);
+	} else if (ns == min) {
 		superb = malloc((min - 1) * sizeof(double));
 		if (superb == NULL) {
 			return luaL_error(L, "cannot allocate elements");
@@ -315,6 +925,114 @@ static int linear_svd (lua_State *L) {
 	return 1;
 }
 
+static int linear_rsvd (lua_State *L) {
+	size_t            m, n, k, l, i, j, size;
+	double           *omega, *y, *z, *b, *ub, *vtb, *sb, *tau;
+	lapack_int        result;
+	lua_Integer       oversampling, iterations;
+	linear_arg_u      args[3];
+	linear_random_t  *rs;
+	linear_vector_t  *s;
+	linear_matrix_t  *A, *U, *VT;
+
+	/* check arguments */
+	A = luaL_checkudata(L, 1, LINEAR_MATRIX);
+	U = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	s = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	VT = luaL_checkudata(L, 4, LINEAR_MATRIX);
+	m = A->rows;
+	n = A->cols;
+	k = s->length;
+	luaL_argcheck(L, k >= 1 && k <= (m < n ? m : n), 3, "dimension mismatch");
+	luaL_argcheck(L, U->rows == m && U->cols == k, 2, "dimension mismatch");
+	luaL_argcheck(L, VT->rows == k && VT->cols == n, 4, "dimension mismatch");
+	linear_checkargs(L, 5, 0, linear_params_rsvd, args);
+	oversampling = args[0].i;
+	luaL_argcheck(L, oversampling >= 0, 5, "bad oversampling");
+	iterations = args[1].i;
+	luaL_argcheck(L, iterations >= 0, 6, "bad iterations");
+	rs = args[2].r;
+	l = k + oversampling;
+	if (l > (m < n ? m : n)) {
+		l = m < n ? m : n;
+	}
+
+	/* allocate workspace */
+	size = 2 * n * l + m * l + 2 * l * n + l * l + 2 * l;
+	omega = malloc(size * sizeof(double));
+	if (omega == NULL) {
+		return luaL_error(L, "cannot allocate elements");
+	}
+	z = omega + n * l;
+	y = z + n * l;
+	b = y + m * l;
+	vtb = b + l * n;
+	ub = vtb + l * n;
+	sb = ub + l * l;
+	tau = sb + l;
+
+	/* sample the range of A with a Gaussian test matrix */
+	linear_normalfill(rs, omega, 1, n * l);
+	cblas_dgemm(CblasColMajor, linear_ordertranspose(CblasNoTrans, A->order, CblasColMajor),
+			CblasNoTrans, m, l, n, 1.0, A->values, A->ld, omega, n, 0.0, y, m);
+
+	/* power iterations, re-orthonormalizing each step for numerical stability */
+	for (i = 0; i < (size_t)iterations; i++) {
+		if (LAPACKE_dgeqrf(LAPACK_COL_MAJOR, m, l, y, m, tau) != 0
+				|| LAPACKE_dorgqr(LAPACK_COL_MAJOR, m, l, l, y, m, tau) != 0) {
+			free(omega);
+			return luaL_error(L, "internal error");
+		}
+		cblas_dgemm(CblasColMajor, linear_ordertranspose(CblasTrans, A->order,
+				CblasColMajor), CblasNoTrans, n, l, m, 1.0, A->values, A->ld, y, m, 0.0,
+				z, n);
+		if (LAPACKE_dgeqrf(LAPACK_COL_MAJOR, n, l, z, n, tau) != 0
+				|| LAPACKE_dorgqr(LAPACK_COL_MAJOR, n, l, l, z, n, tau) != 0) {
+			free(omega);
+			return luaL_error(L, "internal error");
+		}
+		cblas_dgemm(CblasColMajor, linear_ordertranspose(CblasNoTrans, A->order,
+				CblasColMajor), CblasNoTrans, m, l, n, 1.0, A->values, A->ld, z, n, 0.0,
+				y, m);
+	}
+
+	/* orthonormal basis Q of the range, and projection B = Q^T A */
+	if (LAPACKE_dgeqrf(LAPACK_COL_MAJOR, m, l, y, m, tau) != 0
+			|| LAPACKE_dorgqr(LAPACK_COL_MAJOR, m, l, l, y, m, tau) != 0) {
+		free(omega);
+		return luaL_error(L, "internal error");
+	}
+	cblas_dgemm(CblasColMajor, CblasTrans, linear_ordertranspose(CblasNoTrans, A->order,
+			CblasColMajor), l, n, m, 1.0, y, m, A->values, A->ld, 0.0, b, l);
+
+	/* decompose the small matrix B, and lift its left singular vectors */
+	result = LAPACKE_dgesdd(LAPACK_COL_MAJOR, 'S', l, n, b, l, sb, ub, l, vtb, l);
+	if (result != 0) {
+		free(omega);
+		if (result < 0) {
+			return luaL_error(L, "internal error");
+		}
+		lua_pushboolean(L, 0);
+		return 1;
+	}
+	cblas_dgemm(U->order, linear_ordertranspose(CblasNoTrans, CblasColMajor, U->order),
+			linear_ordertranspose(CblasNoTrans, CblasColMajor, U->order), m, k, l, 1.0, y,
+			m, ub, l, 0.0, U->values, U->ld);
+	for (i = 0; i < k; i++) {
+		s->values[i * s->inc] = sb[i];
+		for (j = 0; j < n; j++) {
+			if (VT->order == CblasRowMajor) {
+				VT->values[i * VT->ld + j] = vtb[j * l + i];
+			} else {
+				VT->values[j * VT->ld + i] = vtb[j * l + i];
+			}
+		}
+	}
+	free(omega);
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
 static int linear_cov (lua_State *L) {
 	size_t            i, j, k, ddof;
 	double           *means, *v, *vi, *vj, sum;
@@ -486,49 +1204,216 @@ static int linear_ranks (lua_State *L) {
 	return 0;
 }
 
-static int linear_quantile (lua_State *L) {
-	size_t            i, index;
-	double           *s, *v, rank, pos, frac;
-	linear_vector_t  *x, *r;
+static int linear_index_comparison (const void *a, const void *b) {
+	size_t  ka, kb;
 
-	/* check arguments, and create sorted vector */
-	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
-	r = luaL_checkudata(L, 2, LINEAR_VECTOR);
-	s = malloc(x->length * sizeof(double));
-	if (s == NULL) {
-		return luaL_error(L, "cannot allocate components");
+	ka = *(const size_t *)a;
+	kb = *(const size_t *)b;
+	return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+static void linear_select (double *s, size_t lower, size_t upper, size_t k) {
+	size_t  i, j, mid;
+	double  pivot, t;
+
+	/* partially orders s[lower..upper] such that s[k] is in its sorted position */
+	while (upper - lower >= 2) {
+		/* median of three; s[lower] and s[upper] act as sentinels */
+		mid = lower + (upper - lower) / 2;
+		if (s[mid] < s[lower]) {
+			t = s[mid]; s[mid] = s[lower]; s[lower] = t;
+		}
+		if (s[upper] < s[lower]) {
+			t = s[upper]; s[upper] = s[lower]; s[lower] = t;
+		}
+		if (s[upper] < s[mid]) {
+			t = s[upper]; s[upper] = s[mid]; s[mid] = t;
+		}
+		pivot = s[mid];
+
+		/* partition */
+		i = lower;
+		j = upper;
+		for (;;) {
+			do {
+				i++;
+			} while (s[i] < pivot);
+			do {
+				j--;
+			} while (s[j] > pivot);
+			if (i >= j) {
+				break;
+			}
+			t = s[i]; s[i] = s[j]; s[j] = t;
+		}
+		if (k <= j) {
+			upper = j;
+		} else {
+			lower = j + 1;
+		}
 	}
-	v = x->values;
-	for (i = 0; i < x->length; i++) {
-		if (isnan(*v)) {
-			free(s);
-			for (i = 0; i < r->length; i++) {
-				r->values[i * r->inc] = NAN;
+	if (upper > lower && s[upper] < s[lower]) {
+		t = s[upper]; s[upper] = s[lower]; s[lower] = t;
+	}
+}
+
+static void linear_multiselect (double *s, size_t lower, size_t upper, const size_t *k,
+		size_t klower, size_t kupper) {
+	size_t  mid;
+
+	/* places the sorted positions k[klower..kupper) of s[lower..upper] */
+	while (klower < kupper) {
+		mid = klower + (kupper - klower) / 2;
+		linear_select(s, lower, upper, k[mid]);
+		if (klower < mid && k[mid] > lower) {
+			linear_multiselect(s, lower, k[mid] - 1, k, klower, mid);
+		}
+		lower = k[mid] + 1;
+		klower = mid + 1;
+	}
+}
+
+static void linear_quantiles (double *s, size_t *k, size_t n, const double *x, size_t incx,
+		const double *r, size_t nr, size_t incr, double *q, size_t incq) {
+	size_t  i, j, nk, index;
+	double  rank, pos, frac;
+
+	/* copy components */
+	for (i = 0; i < n; i++) {
+		if (isnan(x[i * incx])) {
+			for (j = 0; j < nr; j++) {
+				q[j * incq] = NAN;
 			}
-			return 0;
+			return;
+		}
+		s[i] = x[i * incx];
+	}
+
+	/* select the required order statistics */
+	nk = 0;
+	for (j = 0; j < nr; j++) {
+		rank = r[j * incr];
+		if (rank >= 0 && rank <= 1) {
+			pos = rank * (n - 1);
+			index = floor(pos);
+			k[nk++] = index;
+			if (fmod(pos, 1) > 0) {
+				k[nk++] = index + 1;
+			}
+		}
+	}
+	qsort(k, nk, sizeof(size_t), linear_index_comparison);
+	for (i = 0, j = 0; i < nk; i++) {
+		if (j == 0 || k[i] != k[j - 1]) {
+			k[j++] = k[i];
 		}
-		s[i] = *v;
-		v += x->inc;
 	}
-	qsort(s, x->length, sizeof(double), linear_comparison_handler);
+	linear_multiselect(s, 0, n - 1, k, 0, j);
 
 	/* calculate quantiles */
-	for (i = 0; i < r->length; i++) {
-		rank = r->values[i * r->inc];
+	for (j = 0; j < nr; j++) {
+		rank = r[j * incr];
 		if (rank >= 0 && rank <= 1) {
-			pos = rank * (x->length - 1);
+			pos = rank * (n - 1);
 			frac = fmod(pos, 1);
 			index = floor(pos);
 			if (frac > 0) {
-				r->values[i * r->inc] = s[index] + (s[index + 1] - s[index]) * frac;
+				q[j * incq] = s[index] + (s[index + 1] - s[index]) * frac;
 			} else {
-				r->values[i * r->inc] = s[index];
+				q[j * incq] = s[index];
 			}
 		} else {
-			r->values[i * r->inc] = NAN;
+			q[j * incq] = NAN;
 		}
 	}
+}
+
+static int linear_quantile_block (void *arg, size_t start, size_t end) {
+	double                 *s;
+	size_t                  i, *k;
+	linear_quantile_job_t  *job;
+
+	job = arg;
+	s = malloc(job->length * sizeof(double));
+	k = malloc(2 * job->nr * sizeof(size_t));
+	if (s == NULL || k == NULL) {
+		free(s);
+		free(k);
+		return -1;
+	}
+	for (i = start; i < end; i++) {
+		linear_quantiles(s, k, job->length, &job->x[i * job->ldx], job->incx, job->r, job->nr,
+				job->incr, &job->q[i * job->ldq], job->incq);
+	}
 	free(s);
+	free(k);
+	return 0;
+}
+
+static int linear_quantile (lua_State *L) {
+	size_t                  count;
+	double                 *s;
+	size_t                 *k;
+	CBLAS_ORDER             order;
+	linear_vector_t        *x, *r;
+	linear_matrix_t        *X, *Q;
+	linear_quantile_job_t   job;
+
+	/* vector */
+	x = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (x != NULL) {
+		r = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		s = malloc(x->length * sizeof(double));
+		k = malloc(2 * r->length * sizeof(size_t));
+		if (s == NULL || k == NULL) {
+			free(s);
+			free(k);
+			return luaL_error(L, "cannot allocate components");
+		}
+		linear_quantiles(s, k, x->length, x->values, x->inc, r->values, r->length, r->inc,
+				r->values, r->inc);
+		free(s);
+		free(k);
+		return 0;
+	}
+
+	/* matrix */
+	X = luaL_testudata(L, 1, LINEAR_MATRIX);
+	if (X == NULL) {
+		return linear_argerror(L, 1, 0);
+	}
+	r = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	Q = luaL_checkudata(L, 3, LINEAR_MATRIX);
+	order = linear_checkorder(L, 4);
+	job.nr = r->length;
+	job.r = r->values;
+	job.incr = r->inc;
+	job.x = X->values;
+	job.q = Q->values;
+	if (order == CblasRowMajor) {
+		luaL_argcheck(L, Q->rows == X->rows && Q->cols == r->length, 3,
+				"dimension mismatch");
+		count = X->rows;
+		job.length = X->cols;
+		job.incx = X->order == CblasRowMajor ? 1 : X->ld;
+		job.ldx = X->order == CblasRowMajor ? X->ld : 1;
+		job.incq = Q->order == CblasRowMajor ? 1 : Q->ld;
+		job.ldq = Q->order == CblasRowMajor ? Q->ld : 1;
+	} else {
+		luaL_argcheck(L, Q->rows == r->length && Q->cols == X->cols, 3,
+				"dimension mismatch");
+		count = X->cols;
+		job.length = X->rows;
+		job.incx = X->order == CblasColMajor ? 1 : X->ld;
+		job.ldx = X->order == CblasColMajor ? X->ld : 1;
+		job.incq = Q->order == CblasColMajor ? 1 : Q->ld;
+		job.ldq = Q->order == CblasColMajor ? Q->ld : 1;
+	}
+
+	/* run blocks of vectors */
+	if (linear_parallel(linear_quantile_block, &job, count, NULL, count * job.length) != 0) {
+		return luaL_error(L, "cannot allocate components");
+	}
 	return 0;
 }
 
@@ -557,7 +1442,10 @@ static int linear_rank (lua_State *L) {
 		s[i] = *v;
 		v += x->inc;
 	}
-	qsort(s, x->length, sizeof(double), linear_comparison_handler);
+	if (linear_radixsort(s, 1, s, 1, x->length, 0) != 0) {
+		free(s);
+		return luaL_error(L, "cannot allocate components");
+	}
 
 	/* calculate ranks */
 	for (i = 0; i < q->length; i++) {
@@ -587,182 +1475,967 @@ static int linear_rank (lua_State *L) {
 	return 0;
 }
 
-static int linear_interpolant (lua_State *L) {
-	double            x, y;
-	size_t            lower, upper, mid;
-	linear_spline_t  *spline;
+static int linear_sort (lua_State *L) {
+	int               descending;
+	linear_vector_t  *x, *y;
 
-	spline = lua_touserdata(L, lua_upvalueindex(1));
-	x = luaL_checknumber(L, 1);
-	if (x >= spline->x[0] && x <= spline->x[spline->n]) {
-		/* interpolation */
-		lower = 0;
-		upper = spline->n - 1;
-		while (lower <= upper) {
-			mid = (lower + upper) / 2;
-			if (spline->x[mid] <= x) {
-				lower = mid + 1;
-			} else {
-				upper = mid - 1;
+	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
+	y = lua_isnoneornil(L, 2) ? x : luaL_checkudata(L, 2, LINEAR_VECTOR);
+	luaL_argcheck(L, y->length == x->length, 2, "dimension mismatch");
+	descending = luaL_checkoption(L, 3, "asc", linear_directions);
+	if (linear_radixsort(x->values, x->inc, y->values, y->inc, x->length, descending) != 0) {
+		return luaL_error(L, "cannot allocate components");
+	}
+	return 0;
+}
+
+static int linear_argsort (lua_State *L) {
+	int               descending;
+	size_t            i, *index;
+	linear_vector_t  *x, *p;
+
+	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
+	p = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	luaL_argcheck(L, p->length == x->length, 2, "dimension mismatch");
+	descending = luaL_checkoption(L, 3, "asc", linear_directions);
+	index = malloc(x->length * sizeof(size_t));
+	if (index == NULL) {
+		return luaL_error(L, "cannot allocate indexes");
+	}
+	if (linear_radixargsort(x->values, x->inc, index, x->length, descending) != 0) {
+		free(index);
+		return luaL_error(L, "cannot allocate indexes");
+	}
+	for (i = 0; i < x->length; i++) {
+		p->values[i * p->inc] = (double)(index[i] + 1);
+	}
+	free(index);
+	return 0;
+}
+
+static void linear_gather (const double *xv, size_t xrs, size_t xcs, double *yv, size_t yrs,
+		size_t ycs, const size_t *index, size_t rows, size_t cols) {
+	size_t  i, j, ib, jb, iend, jend;
+
+	/* copy vector index[i] of x to vector i of y in blocks */
+	for (ib = 0; ib < rows; ib += LINEAR_PERMUTE_BLOCK) {
+		iend = rows - ib < LINEAR_PERMUTE_BLOCK ? rows : ib + LINEAR_PERMUTE_BLOCK;
+		for (jb = 0; jb < cols; jb += LINEAR_PERMUTE_BLOCK) {
+			jend = cols - jb < LINEAR_PERMUTE_BLOCK ? cols : jb + LINEAR_PERMUTE_BLOCK;
+			for (i = ib; i < iend; i++) {
+				for (j = jb; j < jend; j++) {
+					yv[i * yrs + j * ycs] = xv[index[i] * xrs + j * xcs];
+				}
 			}
 		}
-		x -= spline->x[upper];
-		y = ((spline->d[upper] * x + spline->c[upper]) * x + spline->b[upper]) * x
-				+ spline->a[upper];
-	} else if (x < spline->x[0]) {
-		/* left extrapolation */
-		switch (spline->extrapolation) {
-		case 0:  /* none */
-			return luaL_argerror(L, 1, "too small");
+	}
+}
 
-		case 1:  /* const */
-			y = spline->a[0];
-			break;
+static int linear_permute (lua_State *L) {
+	size_t            i, n, rows, cols, xrs, xcs, yrs, ycs, *index;
+	double           *xv, *yv, value;
+	CBLAS_ORDER       order;
+	linear_vector_t  *x, *p, *y;
+	linear_matrix_t  *X, *Y;
 
-		case 2:  /* linear */
-			x -= spline->x[0];
-			y = spline->b[0] * x + spline->a[0];
-			break;
+	/* process arguments */
+	p = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	rows = p->length;
+	x = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (x != NULL) {
+		y = luaL_checkudata(L, 3, LINEAR_VECTOR);
+		luaL_argcheck(L, y->length == rows, 3, "dimension mismatch");
+		n = x->length;
+		cols = 1;
+		xv = x->values;
+		xrs = x->inc;
+		xcs = 0;
+		yv = y->values;
+		yrs = y->inc;
+		ycs = 0;
+	} else {
+		X = luaL_testudata(L, 1, LINEAR_MATRIX);
+		if (X == NULL) {
+			return linear_argerror(L, 1, 0);
+		}
+		Y = luaL_checkudata(L, 3, LINEAR_MATRIX);
+		order = linear_checkorder(L, 4);
+		xv = X->values;
+		yv = Y->values;
+		if (order == CblasRowMajor) {
+			luaL_argcheck(L, Y->rows == rows && Y->cols == X->cols, 3, "dimension mismatch");
+			n = X->rows;
+			cols = X->cols;
+			xrs = X->order == CblasRowMajor ? X->ld : 1;
+			xcs = X->order == CblasRowMajor ? 1 : X->ld;
+			yrs = Y->order == CblasRowMajor ? Y->ld : 1;
+			ycs = Y->order == CblasRowMajor ? 1 : Y->ld;
+		} else {
+			luaL_argcheck(L, Y->cols == rows && Y->rows == X->rows, 3, "dimension mismatch");
+			n = X->cols;
+			cols = X->rows;
+			xrs = X->order == CblasColMajor ? X->ld : 1;
+			xcs = X->order == CblasColMajor ? 1 : X->ld;
+			yrs = Y->order == CblasColMajor ? Y->ld : 1;
+			ycs = Y->order == CblasColMajor ? 1 : Y->ld;
+		}
+	}
 
-		case 3:  /* cubic */
-			x -= spline->x[0];
-			y = ((spline->d[0] * x + spline->c[0]) * x + spline->b[0]) * x
-					+ spline->a[0];
-			break;
+	/* check indexes */
+	index = malloc(rows * sizeof(size_t));
+	if (index == NULL) {
+		return luaL_error(L, "cannot allocate indexes");
+	}
+	for (i = 0; i < rows; i++) {
+		value = p->values[i * p->inc];
+		if (!(value >= 1 && value <= n && value == floor(value))) {
+			free(index);
+			return luaL_argerror(L, 2, "bad index");
+		}
+		index[i] = (size_t)value - 1;
+	}
+
+	/* copy */
+	linear_gather(xv, xrs, xcs, yv, yrs, ycs, index, rows, cols);
+	free(index);
+	return 0;
+}
+
+static inline uint64_t linear_mulhi (uint64_t a, uint64_t b, uint64_t *lo) {
+#ifdef __SIZEOF_INT128__
+	__uint128_t  m;
+
+	m = (__uint128_t)a * b;
+	*lo = (uint64_t)m;
+	return (uint64_t)(m >> 64);
+#else
+	uint64_t  al, ah, bl, bh, p0, p1, p2, p3, mid;
+
+	/* 64x64 to 128 bit multiply from 32 bit halves */
+	al = a & 0xffffffff;
+	ah = a >> 32;
+	bl = b & 0xffffffff;
+	bh = b >> 32;
+	p0 = al * bl;
+	p1 = al * bh;
+	p2 = ah * bl;
+	p3 = ah * bh;
+	mid = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+	*lo = a * b;
+	return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static inline size_t linear_bounded (linear_random_t *r, size_t s) {
+	uint64_t  h, l, t;
+
+	/* source: Lemire, Fast Random Integer Generation in an Interval, 2019; the division is only
+	   taken in the rare case that the draw lands in the biased range */
+	h = linear_mulhi(linear_randombits(r), s, &l);
+	if (l < s) {
+		t = -(uint64_t)s % s;
+		while (l < t) {
+			h = linear_mulhi(linear_randombits(r), s, &l);
+		}
+	}
+	return (size_t)h;
+}
+
+static int linear_shuffle (lua_State *L) {
+	size_t            i, j, n, cols, rs, cs;
+	double           *v, t;
+	CBLAS_ORDER       order;
+	linear_arg_u      args[1];
+	linear_vector_t  *x;
+	linear_matrix_t  *X;
+
+	/* process arguments */
+	x = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (x != NULL) {
+		linear_checkargs(L, 2, 0, linear_params_random, args);
+		for (i = x->length - 1; i > 0; i--) {
+			j = linear_bounded(args[0].r, i + 1);
+			t = x->values[i * x->inc];
+			x->values[i * x->inc] = x->values[j * x->inc];
+			x->values[j * x->inc] = t;
+		}
+		return 0;
+	}
+	X = luaL_testudata(L, 1, LINEAR_MATRIX);
+	if (X == NULL) {
+		return linear_argerror(L, 1, 0);
+	}
+	order = linear_checkorder(L, 2);
+	linear_checkargs(L, 3, 0, linear_params_random, args);
+	v = X->values;
+	if (order == CblasRowMajor) {
+		n = X->rows;
+		cols = X->cols;
+		rs = X->order == CblasRowMajor ? X->ld : 1;
+		cs = X->order == CblasRowMajor ? 1 : X->ld;
+	} else {
+		n = X->cols;
+		cols = X->rows;
+		rs = X->order == CblasColMajor ? X->ld : 1;
+		cs = X->order == CblasColMajor ? 1 : X->ld;
+	}
+
+	/* swap vectors */
+	for (i = n - 1; i > 0; i--) {
+		j = linear_bounded(args[0].r, i + 1);
+		if (j != i) {
+			cblas_dswap(cols, &v[i * rs], cs, &v[j * rs], cs);
+		}
+	}
+	return 0;
+}
+
+static int linear_sample (lua_State *L) {
+	int               replace;
+	size_t            i, j, t, n, rows, cols, xrs, xcs, yrs, ycs, *index;
+	double           *xv, *yv;
+	CBLAS_ORDER       order;
+	linear_arg_u      args[1];
+	linear_vector_t  *x, *y;
+	linear_matrix_t  *X, *Y;
+
+	/* process arguments */
+	replace = lua_toboolean(L, 3);
+	x = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (x != NULL) {
+		y = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		linear_checkargs(L, 4, 0, linear_params_random, args);
+		n = x->length;
+		rows = y->length;
+		cols = 1;
+		xv = x->values;
+		xrs = x->inc;
+		xcs = 0;
+		yv = y->values;
+		yrs = y->inc;
+		ycs = 0;
+	} else {
+		X = luaL_testudata(L, 1, LINEAR_MATRIX);
+		if (X == NULL) {
+			return linear_argerror(L, 1, 0);
+		}
+		Y = luaL_checkudata(L, 2, LINEAR_MATRIX);
+		order = linear_checkorder(L, 4);
+		linear_checkargs(L, 5, 0, linear_params_random, args);
+		xv = X->values;
+		yv = Y->values;
+		if (order == CblasRowMajor) {
+			luaL_argcheck(L, Y->cols == X->cols, 2, "dimension mismatch");
+			n = X->rows;
+			rows = Y->rows;
+			cols = X->cols;
+			xrs = X->order == CblasRowMajor ? X->ld : 1;
+			xcs = X->order == CblasRowMajor ? 1 : X->ld;
+			yrs = Y->order == CblasRowMajor ? Y->ld : 1;
+			ycs = Y->order == CblasRowMajor ? 1 : Y->ld;
+		} else {
+			luaL_argcheck(L, Y->rows == X->rows, 2, "dimension mismatch");
+			n = X->cols;
+			rows = Y->cols;
+			cols = X->rows;
+			xrs = X->order == CblasColMajor ? X->ld : 1;
+			xcs = X->order == CblasColMajor ? 1 : X->ld;
+			yrs = Y->order == CblasColMajor ? Y->ld : 1;
+			ycs = Y->order == CblasColMajor ? 1 : Y->ld;
+		}
+	}
+	luaL_argcheck(L, replace || rows <= n, 2, "dimension mismatch");
+
+	/* draw indexes; without replacement, by a partial Fisher-Yates shuffle */
+	index = malloc((replace ? rows : n) * sizeof(size_t));
+	if (index == NULL) {
+		return luaL_error(L, "cannot allocate indexes");
+	}
+	if (replace) {
+		for (i = 0; i < rows; i++) {
+			index[i] = linear_bounded(args[0].r, n);
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			index[i] = i;
+		}
+		for (i = 0; i < rows; i++) {
+			j = i + linear_bounded(args[0].r, n - i);
+			t = index[i];
+			index[i] = index[j];
+			index[j] = t;
+		}
+	}
+
+	/* copy */
+	linear_gather(xv, xrs, xcs, yv, yrs, ycs, index, rows, cols);
+	free(index);
+	return 0;
+}
+
+static inline size_t linear_lowerbound (const double *s, size_t n, double q, int right) {
+	size_t         half;
+	const double  *base;
 
-		default:
-			return 0;  /* not reached */
+	/* branchless binary search; counts the components less than (or equal to) q */
+	if (n == 0) {
+		return 0;
+	}
+	base = s;
+	while (n > 1) {
+		half = n / 2;
+		base = (right ? base[half - 1] <= q : base[half - 1] < q) ? base + half : base;
+		n -= half;
+	}
+	return (size_t)(base - s) + (right ? *base <= q : *base < q);
+}
+
+static int linear_searchsorted (lua_State *L) {
+	int               right, sorted;
+	size_t            i, n, count, step;
+	double           *s, q, prev;
+	linear_vector_t  *x, *v, *c;
+
+	/* process arguments */
+	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
+	v = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	c = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	luaL_argcheck(L, c->length == v->length, 3, "dimension mismatch");
+	right = luaL_checkoption(L, 4, "left", linear_searchsides);
+	n = x->length;
+	if (x->inc != 1) {
+		s = malloc(n * sizeof(double));
+		if (s == NULL) {
+			return luaL_error(L, "cannot allocate components");
+		}
+		for (i = 0; i < n; i++) {
+			s[i] = x->values[i * x->inc];
+		}
+	} else {
+		s = x->values;
+	}
+
+	/* sorted queries gallop from the previous count; others are searched */
+	sorted = 1;
+	prev = -INFINITY;
+	for (i = 0; i < v->length && sorted; i++) {
+		q = v->values[i * v->inc];
+		sorted = q >= prev;
+		prev = q;
+	}
+	count = 0;
+	for (i = 0; i < v->length; i++) {
+		q = v->values[i * v->inc];
+		if (isnan(q)) {
+			c->values[i * c->inc] = NAN;
+			continue;
+		}
+		if (sorted) {
+			step = 1;
+			while (count + step <= n && (right ? s[count + step - 1] <= q
+					: s[count + step - 1] < q)) {
+				count += step;
+				step *= 2;
+			}
+			step = n - count < step ? n - count : step;
+			count += linear_lowerbound(&s[count], step, q, right);
+		} else {
+			count = linear_lowerbound(s, n, q, right);
+		}
+		c->values[i * c->inc] = (double)count;
+	}
+	if (s != x->values) {
+		free(s);
+	}
+	return 0;
+}
+
+static inline int linear_topkbefore (double a, size_t ia, double b, size_t ib, int descending) {
+	/* orders by value in the direction, with NaNs last and ties by index */
+	if (isnan(a) || isnan(b)) {
+		return isnan(b) && (!isnan(a) || ia < ib);
+	}
+	if (a != b) {
+		return descending ? a > b : a < b;
+	}
+	return ia < ib;
+}
+
+static void linear_topkheap (double *hv, size_t *hi, size_t size, size_t root, int descending) {
+	size_t  child, ti;
+	double  tv;
+
+	/* sifts down; the root of the heap is its last element in selection order */
+	while ((child = 2 * root + 1) < size) {
+		if (child + 1 < size && linear_topkbefore(hv[child], hi[child], hv[child + 1],
+				hi[child + 1], descending)) {
+			child++;
 		}
-	} else if (x > spline->x[spline->n]) {
+		if (!linear_topkbefore(hv[root], hi[root], hv[child], hi[child], descending)) {
+			return;
+		}
+		tv = hv[root]; hv[root] = hv[child]; hv[child] = tv;
+		ti = hi[root]; hi[root] = hi[child]; hi[child] = ti;
+		root = child;
+	}
+}
+
+static void linear_topkselect (const double *x, size_t incx, size_t n, size_t k, int descending,
+		double *hv, size_t *hi) {
+	size_t  i, ti;
+	double  tv;
+
+	/* build a heap of the first k components */
+	for (i = 0; i < k; i++) {
+		hv[i] = x[i * incx];
+		hi[i] = i;
+	}
+	for (i = k / 2; i > 0; i--) {
+		linear_topkheap(hv, hi, k, i - 1, descending);
+	}
+
+	/* replace the root with better components */
+	for (i = k; i < n; i++) {
+		if (linear_topkbefore(x[i * incx], i, hv[0], hi[0], descending)) {
+			hv[0] = x[i * incx];
+			hi[0] = i;
+			linear_topkheap(hv, hi, k, 0, descending);
+		}
+	}
+
+	/* sort the heap in selection order */
+	for (i = k; i > 1; i--) {
+		tv = hv[0]; hv[0] = hv[i - 1]; hv[i - 1] = tv;
+		ti = hi[0]; hi[0] = hi[i - 1]; hi[i - 1] = ti;
+		linear_topkheap(hv, hi, i - 1, 0, descending);
+	}
+}
+
+static int linear_topk (lua_State *L) {
+	int               descending;
+	size_t            i, j, k, n, count, incx, ldx, incv, ldv, incp, ldp, *hi;
+	double           *xv, *vv, *pv, *hv;
+	linear_vector_t  *x, *v, *p;
+	linear_matrix_t  *X, *V, *P;
+
+	/* process arguments */
+	x = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (x != NULL) {
+		v = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		luaL_argcheck(L, v->length <= x->length, 2, "dimension mismatch");
+		p = lua_isnoneornil(L, 3) ? NULL : luaL_checkudata(L, 3, LINEAR_VECTOR);
+		luaL_argcheck(L, p == NULL || p->length == v->length, 3, "dimension mismatch");
+		count = 1;
+		n = x->length;
+		k = v->length;
+		xv = x->values;
+		incx = x->inc;
+		ldx = 0;
+		vv = v->values;
+		incv = v->inc;
+		ldv = 0;
+		pv = p != NULL ? p->values : NULL;
+		incp = p != NULL ? p->inc : 0;
+		ldp = 0;
+	} else {
+		X = luaL_testudata(L, 1, LINEAR_MATRIX);
+		if (X == NULL) {
+			return linear_argerror(L, 1, 0);
+		}
+		V = luaL_checkudata(L, 2, LINEAR_MATRIX);
+		luaL_argcheck(L, V->rows == X->rows && V->cols <= X->cols, 2, "dimension mismatch");
+		P = lua_isnoneornil(L, 3) ? NULL : luaL_checkudata(L, 3, LINEAR_MATRIX);
+		luaL_argcheck(L, P == NULL || (P->rows == V->rows && P->cols == V->cols), 3,
+				"dimension mismatch");
+		count = X->rows;
+		n = X->cols;
+		k = V->cols;
+		xv = X->values;
+		incx = X->order == CblasRowMajor ? 1 : X->ld;
+		ldx = X->order == CblasRowMajor ? X->ld : 1;
+		vv = V->values;
+		incv = V->order == CblasRowMajor ? 1 : V->ld;
+		ldv = V->order == CblasRowMajor ? V->ld : 1;
+		pv = P != NULL ? P->values : NULL;
+		incp = P != NULL ? (P->order == CblasRowMajor ? 1 : P->ld) : 0;
+		ldp = P != NULL ? (P->order == CblasRowMajor ? P->ld : 1) : 0;
+	}
+	descending = luaL_checkoption(L, 4, "desc", linear_directions);
+
+	/* select */
+	hv = malloc(k * sizeof(double));
+	hi = malloc(k * sizeof(size_t));
+	if (hv == NULL || hi == NULL) {
+		free(hv);
+		free(hi);
+		return luaL_error(L, "cannot allocate components");
+	}
+	for (i = 0; i < count; i++) {
+		linear_topkselect(&xv[i * ldx], incx, n, k, descending, hv, hi);
+		for (j = 0; j < k; j++) {
+			vv[i * ldv + j * incv] = hv[j];
+			if (pv != NULL) {
+				pv[i * ldp + j * incp] = (double)(hi[j] + 1);
+			}
+		}
+	}
+	free(hv);
+	free(hi);
+	return 0;
+}
+
+static size_t linear_splinesegment (linear_spline_t *spline, double x, size_t hint) {
+	size_t  lower, upper, mid;
+	double  index;
+
+	/* arithmetic lookup; uniform and log-uniform grids */
+	if (spline->grid != 0) {
+		index = ((spline->grid == 1 ? x : log(x)) - spline->origin) * spline->scale;
+		mid = index > 0 ? (size_t)index : 0;
+		if (mid > spline->n - 1) {
+			mid = spline->n - 1;
+		}
+		while (mid > 0 && x < spline->x[mid]) {
+			mid--;
+		}
+		while (mid < spline->n - 1 && x >= spline->x[mid + 1]) {
+			mid++;
+		}
+		return mid;
+	}
+
+	/* hinted search; sorted arguments mostly hit the hinted or the next polynomial */
+	if (hint < spline->n && x >= spline->x[hint]) {
+		if (hint == spline->n - 1 || x < spline->x[hint + 1]) {
+			return hint;
+		}
+		if (hint + 1 == spline->n - 1 || x < spline->x[hint + 2]) {
+			return hint + 1;
+		}
+	}
+
+	/* binary search */
+	lower = 0;
+	upper = spline->n - 1;
+	while (lower <= upper) {
+		mid = (lower + upper) / 2;
+		if (spline->x[mid] <= x) {
+			lower = mid + 1;
+		} else {
+			upper = mid - 1;
+		}
+	}
+	return upper;
+}
+
+static int linear_evalspline (linear_spline_t *spline, double x, int evaluation, size_t *hint,
+		double *y, size_t incy) {
+	int     form;
+	size_t  k, n, m, ia, ib;
+	double  a, b, c, d, s;
+
+	/* select polynomial */
+	n = spline->n;
+	m = spline->m;
+	if (x >= spline->x[0] && x <= spline->x[n]) {
+		/* interpolation */
+		ia = ib = linear_splinesegment(spline, x, *hint);
+		*hint = ia;
+		x -= spline->x[ia];
+		form = LINEAR_SPLINE_CUBIC;
+	} else if (x < spline->x[0]) {
+		/* left extrapolation */
+		if (spline->extrapolation == 0) {
+			return -1;
+		}
+		ia = ib = 0;
+		x -= spline->x[0];
+		form = spline->extrapolation - 1;  /* extrapolation const, linear, cubic */
+	} else if (x > spline->x[n]) {
 		/* right extrapolation */
-		switch (spline->extrapolation) {
-		case 0:  /* none */
-			return luaL_argerror(L, 1, "too large");
+		if (spline->extrapolation == 0) {
+			return 1;
+		}
+		if (spline->extrapolation == 3) {  /* cubic */
+			ia = ib = n - 1;
+			x -= spline->x[n - 1];
+		} else {
+			ia = n;
+			ib = n - 1;
+			x -= spline->x[n];
+		}
+		form = spline->extrapolation - 1;
+	} else {
+		return 2;
+	}
 
-		case 1:  /* const */
-			y = spline->a[spline->n];
+	/* evaluate */
+	for (k = 0; k < m; k++) {
+		a = spline->a[ia * m + k];
+		b = form >= LINEAR_SPLINE_LINEAR ? spline->b[ib * m + k] : 0.0;
+		c = form == LINEAR_SPLINE_CUBIC ? spline->c[ib * m + k] : 0.0;
+		d = form == LINEAR_SPLINE_CUBIC ? spline->d[ib * m + k] : 0.0;
+		s = spline->s[ia * m + k];
+		switch (evaluation) {
+		case 0:  /* value */
+			y[k * incy] = ((d * x + c) * x + b) * x + a;
 			break;
 
-		case 2:  /* linear */
-			x -= spline->x[spline->n];
-			y = spline->b[spline->n - 1] * x + spline->a[spline->n];
+		case 1:  /* derivative */
+			y[k * incy] = (3 * d * x + 2 * c) * x + b;
 			break;
 
-		case 3:  /* cubic */
-			x -= spline->x[spline->n - 1];
-			y = ((spline->d[spline->n - 1] * x + spline->c[spline->n - 1]) * x
-					+ spline->b[spline->n - 1]) * x + spline->a[spline->n - 1];
+		case 2:  /* integral */
+			y[k * incy] = s + (((d / 4 * x + c / 3) * x + b / 2) * x + a) * x;
 			break;
+		}
+	}
+	return 0;
+}
 
-		default:
-			return 0;  /* not reached */
+static int linear_interpolant (lua_State *L) {
+	int               evaluation, result;
+	size_t            i, hint;
+	double            y;
+	linear_vector_t  *u, *v;
+	linear_matrix_t  *V;
+	linear_spline_t  *spline;
+
+	spline = lua_touserdata(L, lua_upvalueindex(1));
+	hint = 0;
+	y = 0.0;
+	u = luaL_testudata(L, 1, LINEAR_VECTOR);
+	if (u != NULL && spline->multiple) {
+		V = luaL_checkudata(L, 2, LINEAR_MATRIX);
+		luaL_argcheck(L, V->rows == u->length && V->cols == spline->m, 2,
+				"dimension mismatch");
+		evaluation = luaL_checkoption(L, 3, "value", linear_evaluations);
+		for (i = 0; i < u->length; i++) {
+			result = linear_evalspline(spline, u->values[i * u->inc], evaluation, &hint,
+					V->order == CblasRowMajor ? &V->values[i * V->ld] : &V->values[i],
+					V->order == CblasRowMajor ? 1 : V->ld);
+			if (result != 0) {
+				break;
+			}
+		}
+	} else if (u != NULL) {
+		v = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		luaL_argcheck(L, v->length == u->length, 2, "dimension mismatch");
+		evaluation = luaL_checkoption(L, 3, "value", linear_evaluations);
+		for (i = 0; i < u->length; i++) {
+			result = linear_evalspline(spline, u->values[i * u->inc], evaluation, &hint,
+					&v->values[i * v->inc], 1);
+			if (result != 0) {
+				break;
+			}
 		}
+	} else if (spline->multiple) {
+		v = luaL_checkudata(L, 2, LINEAR_VECTOR);
+		luaL_argcheck(L, v->length == spline->m, 2, "dimension mismatch");
+		evaluation = luaL_checkoption(L, 3, "value", linear_evaluations);
+		result = linear_evalspline(spline, luaL_checknumber(L, 1), evaluation, &hint,
+				v->values, v->inc);
 	} else {
+		evaluation = luaL_checkoption(L, 2, "value", linear_evaluations);
+		result = linear_evalspline(spline, luaL_checknumber(L, 1), evaluation, &hint, &y, 1);
+	}
+	switch (result) {
+	case 0:
+		break;
+
+	case -1:
+		return luaL_argerror(L, 1, "too small");
+
+	case 1:
+		return luaL_argerror(L, 1, "too large");
+
+	default:
 		return luaL_argerror(L, 1, "bad value");
 	}
+	if (u != NULL || spline->multiple) {
+		return 0;
+	}
 	lua_pushnumber(L, y);
 	return 1;
 }
 
 static int linear_spline (lua_State *L) {
 	int                    boundary, extrapolation;
-	double                *h, *dl, *d, *du, *b;
-	double                 da, db;
-	size_t                 i, n;
+	double                *dl, *d, *du, *r, *yv;
+	double                 da, db, h, h0, h1;
+	size_t                 i, k, n, m, ys, yt;
 	linear_vector_t       *x, *y;
+	linear_matrix_t       *Y;
 	linear_spline_t       *spline;
 
 	/* process arguments */
 	x = luaL_checkudata(L, 1, LINEAR_VECTOR);
-	y = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	y = luaL_testudata(L, 2, LINEAR_VECTOR);
+	if (y != NULL) {
+		m = 1;
+		ys = y->inc;
+		yt = 0;
+		yv = y->values;
+		luaL_argcheck(L, x->length == y->length, 2, "dimension mismatch");
+	} else {
+		Y = luaL_testudata(L, 2, LINEAR_MATRIX);
+		if (Y == NULL) {
+			return linear_argerror(L, 2, 0);
+		}
+		m = Y->cols;
+		ys = Y->order == CblasRowMajor ? Y->ld : 1;
+		yt = Y->order == CblasRowMajor ? 1 : Y->ld;
+		yv = Y->values;
+		luaL_argcheck(L, x->length == Y->rows, 2, "dimension mismatch");
+	}
 	boundary = luaL_checkoption(L, 3, "not-a-knot", linear_boundaries);
 	extrapolation = luaL_checkoption(L, 4, "none", linear_extrapolations);
 	da = boundary == 1 ? luaL_checknumber(L, 5) : 0.0;  /* clamped */
 	db = boundary == 1 ? luaL_checknumber(L, 6) : 0.0;
 	luaL_argcheck(L, x->length >= (boundary == 0 ? 4 : 3), 1, "bad dimension");
-	luaL_argcheck(L, x->length == y->length, 2, "dimension mismatch");
 	n = x->length - 1;  /* number of polynomials */
 
 	/* prepare the tridiagonal system */
-	spline = lua_newuserdata(L, sizeof(linear_spline_t) + (5 * n + 2) * sizeof(double));
+	spline = lua_newuserdata(L, sizeof(linear_spline_t) + (n + 1 + (5 * n + 2) * m)
+			* sizeof(double));
 	spline->n = n;
+	spline->m = m;
+	spline->multiple = y == NULL;
 	spline->extrapolation = extrapolation;
 	spline->x = (double *)((char *)(spline) + sizeof(linear_spline_t));
 	spline->a = spline->x + (n + 1);
-	spline->b = spline->a + (n + 1);
-	spline->c = spline->b + n;
-	spline->d = spline->c + n;
-	h = spline->d;
+	spline->b = spline->a + (n + 1) * m;
+	spline->c = spline->b + n * m;
+	spline->d = spline->c + n * m;
+	spline->s = spline->d + n * m;
 	dl = spline->b;
-	d = spline->x;
-	du = spline->c;
-	b = spline->a;
+	d = spline->a;
+	du = spline->d;
+	r = spline->s;
+	for (i = 0; i <= n; i++) {
+		spline->x[i] = x->values[i * x->inc];
+	}
 	for (i = 0; i < n; i++) {
-		h[i] = x->values[(i + 1) * x->inc] - x->values[i * x->inc];
-		if (!(h[i] > 0)) {
+		if (!(spline->x[i + 1] - spline->x[i] > 0)) {
 			return luaL_error(L, "bad order at indexes (%d,%d)", i + 1, i + 2);
 		}
 	}
+
+	/* detect uniform and log-uniform grids */
+	spline->grid = 1;
+	h = (spline->x[n] - spline->x[0]) / n;
+	for (i = 0; i < n && spline->grid == 1; i++) {
+		if (fabs(spline->x[i + 1] - spline->x[i] - h) > LINEAR_SPLINE_GRID * h) {
+			spline->grid = spline->x[0] > 0 ? 2 : 0;
+		}
+	}
+	if (spline->grid == 2) {
+		h = log(spline->x[n] / spline->x[0]) / n;
+		for (i = 0; i < n && spline->grid == 2; i++) {
+			if (fabs(log(spline->x[i + 1] / spline->x[i]) - h) > LINEAR_SPLINE_GRID * h) {
+				spline->grid = 0;
+			}
+		}
+	}
+	spline->origin = spline->grid == 2 ? log(spline->x[0]) : spline->x[0];
+	spline->scale = 1 / h;
+#define YV(i, k)  yv[(i) * ys + (k) * yt]
 	for (i = 1; i < n; i++) {
-		dl[i - 1] = h[i - 1];
-		d[i] = 2 * (h[i - 1] + h[i]);
-		du[i] = h[i];
-		b[i] = 3 * ((y->values[(i + 1) * y->inc] - y->values[i * y->inc]) / h[i]
-				- (y->values[i * y->inc] - y->values[(i - 1) * y->inc]) / h[i- 1]);
+		h0 = spline->x[i] - spline->x[i - 1];
+		h1 = spline->x[i + 1] - spline->x[i];
+		dl[i - 1] = h0;
+		d[i] = 2 * (h0 + h1);
+		du[i] = h1;
+		for (k = 0; k < m; k++) {
+			r[i * m + k] = 3 * ((YV(i + 1, k) - YV(i, k)) / h1 - (YV(i, k) - YV(i - 1, k))
+					/ h0);
+		}
 	}
+	h0 = spline->x[1] - spline->x[0];
+	h1 = spline->x[n] - spline->x[n - 1];
 	switch (boundary) {
 	case 0:  /* not-a-knot */
-		d[0] = h[0] - (h[1] * h[1]) / h[0];
-		du[0] = 3 * h[1] + 2 * h[0] + (h[1] * h[1]) / h[0];
-		b[0] = 3 * ((y->values[2 * y->inc] - y->values[1 * y->inc]) / h[1]
-				- (y->values[1 * y->inc] - y->values[0 * y->inc]) / h[0]);
-		dl[n - 1] = 3 * h[n - 2] + 2 * h[n - 1] + (h[n - 2] * h[n - 2]) / h[n - 1];
-		d[n] = h[n - 1] - (h[n - 2] * h[n - 2]) / h[n - 1];
-		b[n] = 3 * ((y->values[n * y->inc] - y->values[(n - 1) * y->inc]) / h[n - 1]
-				- (y->values[(n - 1) * y->inc] - y->values[(n - 2) * y->inc])
-				/ h[n - 2]);
+		h = spline->x[2] - spline->x[1];
+		d[0] = h0 - (h * h) / h0;
+		du[0] = 3 * h + 2 * h0 + (h * h) / h0;
+		for (k = 0; k < m; k++) {
+			r[k] = 3 * ((YV(2, k) - YV(1, k)) / h - (YV(1, k) - YV(0, k)) / h0);
+		}
+		h = spline->x[n - 1] - spline->x[n - 2];
+		dl[n - 1] = 3 * h + 2 * h1 + (h * h) / h1;
+		d[n] = h1 - (h * h) / h1;
+		for (k = 0; k < m; k++) {
+			r[n * m + k] = 3 * ((YV(n, k) - YV(n - 1, k)) / h1 - (YV(n - 1, k) - YV(n - 2, k))
+					/ h);
+		}
 		break;
 
 	case 1:  /* clamped */
-		d[0] = 2 * h[0];
-		du[0] = h[0];
-		b[0] = 3 * ((y->values[1 * y->inc] - y->values[0 * y->inc]) / h[0] - da);
-		dl[n - 1] = h[n - 1];
-		d[n] = 2 * h[n - 1];
-		b[n] = 3 * (db - (y->values[n * y->inc] - y->values[(n - 1) * y->inc])
-				/ h[n - 1]);
+		d[0] = 2 * h0;
+		du[0] = h0;
+		dl[n - 1] = h1;
+		d[n] = 2 * h1;
+		for (k = 0; k < m; k++) {
+			r[k] = 3 * ((YV(1, k) - YV(0, k)) / h0 - da);
+			r[n * m + k] = 3 * (db - (YV(n, k) - YV(n - 1, k)) / h1);
+		}
 		break;
 
 	case 2:  /* natural */
 		d[0] = 1;
 		du[0] = 0;
-		b[0] = 0;
 		dl[n - 1] = 0;
 		d[n] = 1;
-		b[n] = 0;
+		for (k = 0; k < m; k++) {
+			r[k] = 0;
+			r[n * m + k] = 0;
+		}
 		break;
 	}
 
-	/* solve the tridiagonal system */
-	if (LAPACKE_dgtsv(LAPACK_ROW_MAJOR, n + 1, 1, dl, d, du, b, 1) != 0) {
+	/* solve the tridiagonal system for all curves */
+	if (LAPACKE_dgtsv(LAPACK_ROW_MAJOR, n + 1, m, dl, d, du, r, m) != 0) {
 		return luaL_error(L, "internal error");
 	}
 
 	/* make polynomials */
 	for (i = 0; i < n; i++) {
-		spline->b[i] = (y->values[(i + 1) * y->inc] - y->values[i * y->inc]) / h[i]
-				- (2 * b[i] + b[i + 1]) * h[i] / 3;
-		spline->c[i] = b[i];
-		spline->d[i] = (b[i + 1] - b[i]) / (3 * h[i]);  /* overwrites h[i] */
-		spline->x[i] = x->values[i * x->inc];
-		spline->a[i] = y->values[i * y->inc];  /* overwrites b[i] */
+		h = spline->x[i + 1] - spline->x[i];
+		for (k = 0; k < m; k++) {
+			spline->b[i * m + k] = (YV(i + 1, k) - YV(i, k)) / h
+					- (2 * r[i * m + k] + r[(i + 1) * m + k]) * h / 3;
+			spline->c[i * m + k] = r[i * m + k];
+			spline->d[i * m + k] = (r[(i + 1) * m + k] - r[i * m + k]) / (3 * h);
+		}
+	}
+	for (i = 0; i <= n; i++) {
+		for (k = 0; k < m; k++) {
+			spline->a[i * m + k] = YV(i, k);
+		}
+	}
+
+	/* integrate polynomials; overwrites the solutions */
+	for (k = 0; k < m; k++) {
+		spline->s[k] = 0.0;
+	}
+	for (i = 0; i < n; i++) {
+		h = spline->x[i + 1] - spline->x[i];
+		for (k = 0; k < m; k++) {
+			spline->s[(i + 1) * m + k] = spline->s[i * m + k] + (((spline->d[i * m + k] / 4 * h
+					+ spline->c[i * m + k] / 3) * h + spline->b[i * m + k] / 2) * h
+					+ spline->a[i * m + k]) * h;
+		}
 	}
-	spline->x[n] = x->values[n * x->inc];
-	spline->a[n] = y->values[n * y->inc];
 
 	/* return interpolant */
 	lua_pushcclosure(L, linear_interpolant, 1);
 	return 1;
+#undef YV
+}
+
+static int linear_interp (lua_State *L) {
+	int               extrapolation, sorted;
+	size_t            i, j, k, n, m, lower, upper, mid, fs, ft, ys, yt;
+	double           *fv, *yv, xi, t;
+	linear_vector_t  *xp, *fp, *x, *y;
+	linear_matrix_t  *FP, *Y;
+
+	/* process arguments */
+	xp = luaL_checkudata(L, 1, LINEAR_VECTOR);
+	luaL_argcheck(L, xp->length >= 2, 1, "bad dimension");
+	n = xp->length;
+	fp = luaL_testudata(L, 2, LINEAR_VECTOR);
+	x = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	if (fp != NULL) {
+		luaL_argcheck(L, fp->length == n, 2, "dimension mismatch");
+		y = luaL_checkudata(L, 4, LINEAR_VECTOR);
+		luaL_argcheck(L, y->length == x->length, 4, "dimension mismatch");
+		m = 1;
+		fs = fp->inc;
+		ft = 0;
+		fv = fp->values;
+		ys = y->inc;
+		yt = 0;
+		yv = y->values;
+	} else {
+		FP = luaL_testudata(L, 2, LINEAR_MATRIX);
+		if (FP == NULL) {
+			return linear_argerror(L, 2, 0);
+		}
+		luaL_argcheck(L, FP->rows == n, 2, "dimension mismatch");
+		Y = luaL_checkudata(L, 4, LINEAR_MATRIX);
+		luaL_argcheck(L, Y->rows == x->length && Y->cols == FP->cols, 4,
+				"dimension mismatch");
+		m = FP->cols;
+		fs = FP->order == CblasRowMajor ? FP->ld : 1;
+		ft = FP->order == CblasRowMajor ? 1 : FP->ld;
+		fv = FP->values;
+		ys = Y->order == CblasRowMajor ? Y->ld : 1;
+		yt = Y->order == CblasRowMajor ? 1 : Y->ld;
+		yv = Y->values;
+	}
+	extrapolation = luaL_checkoption(L, 5, "none", linear_extrapolations);
+#define XP(j)  xp->values[(j) * xp->inc]
+	for (j = 0; j < n - 1; j++) {
+		if (!(XP(j + 1) > XP(j))) {
+			return luaL_error(L, "bad order at indexes (%d,%d)", j + 1, j + 2);
+		}
+	}
+
+	/* sorted queries are merged with the cut-ins; others are searched */
+	sorted = 1;
+	for (i = 1; i < x->length && sorted; i++) {
+		sorted = x->values[i * x->inc] >= x->values[(i - 1) * x->inc];
+	}
+
+	/* interpolate */
+	j = 0;
+	for (i = 0; i < x->length; i++) {
+		xi = x->values[i * x->inc];
+		if (xi >= XP(0) && xi <= XP(n - 1)) {
+			if (sorted) {
+				while (j < n - 2 && xi >= XP(j + 1)) {
+					j++;
+				}
+			} else {
+				lower = 0;
+				upper = n - 2;
+				while (lower <= upper) {
+					mid = (lower + upper) / 2;
+					if (XP(mid) <= xi) {
+						lower = mid + 1;
+					} else {
+						upper = mid - 1;
+					}
+				}
+				j = upper;
+			}
+			t = (xi - XP(j)) / (XP(j + 1) - XP(j));
+		} else if (xi < XP(0) || xi > XP(n - 1)) {
+			switch (extrapolation) {
+			case 0:  /* none */
+				return luaL_argerror(L, 3, xi < XP(0) ? "too small" : "too large");
+
+			case 1:  /* const */
+				j = xi < XP(0) ? 0 : n - 2;
+				t = xi < XP(0) ? 0.0 : 1.0;
+				break;
+
+			default:  /* linear, cubic */
+				j = xi < XP(0) ? 0 : n - 2;
+				t = (xi - XP(j)) / (XP(j + 1) - XP(j));
+				break;
+			}
+		} else {
+			return luaL_argerror(L, 3, "bad value");
+		}
+		for (k = 0; k < m; k++) {
+			yv[i * ys + k * yt] = (1 - t) * fv[j * fs + k * ft] + t * fv[(j + 1) * fs
+					+ k * ft];
+		}
+	}
+#undef XP
+	return 0;
 }
 
 int linear_open_program  (lua_State *L) {
@@ -771,28 +2444,43 @@ int linear_open_program  (lua_State *L) {
 		{"ger", linear_ger},
 		{"gemv", linear_gemv},
 		{"gemm", linear_gemm},
+		{"trmv", linear_trmv},
+		{"trsv", linear_trsv},
+		{"trmm", linear_trmm},
+		{"trsm", linear_trsm},
+		{"syr", linear_syr},
+		{"symv", linear_symv},
+		{"symm", linear_symm},
+		{"syrk", linear_syrk},
+		{"syr2k", linear_syr2k},
 		{"gesv", linear_gesv},
 		{"gels", linear_gels},
+		{"gtsv", linear_gtsv},
+		{"gbsv", linear_gbsv},
+		{"pbsv", linear_pbsv},
+		{"gttrf", linear_gttrf},
+		{"gbtrf", linear_gbtrf},
+		{"pbtrf", linear_pbtrf},
 		{"inv", linear_inv},
 		{"det", linear_det},
 		{"svd", linear_svd},
+		{"rsvd", linear_rsvd},
 		{"cov", linear_cov},
 		{"corr", linear_corr},
 		{"ranks", linear_ranks},
 		{"quantile", linear_quantile},
 		{"rank", linear_rank},
+		{"sort", linear_sort},
+		{"argsort", linear_argsort},
+		{"permute", linear_permute},
+		{"shuffle", linear_shuffle},
+		{"sample", linear_sample},
+		{"searchsorted", linear_searchsorted},
+		{"topk", linear_topk},
 		{"spline", linear_spline},
+		{"interp", linear_interp},
 		{ NULL, NULL }
 	};
-#if LUA_VERSION_NUM >= 502
-	luaL_setfuncs(L, functions, 0);
-#else
-	const luaL_Reg  *reg;
-
-	for (reg = functions; reg->name; reg++) {
-		lua_pushcfunction(L, reg->func);
-		lua_setfield(L, -2, reg->name);
-	}
-#endif
+	linear_profile_setfuncs(L, functions);
 	return 0;
 }
@@ -0,0 +1,465 @@
+/*
+ * Lua Linear sparse matrix functions
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <lauxlib.h>
+#include "linear_core.h"
+#include "linear_sparse.h"
+
+
+#if LUA_VERSION_NUM < 502
+#define luaL_testudata  linear_testudata
+#endif
+
+
+typedef struct linear_sparse_job_s {
+	linear_sparse_t  *S;      /* sparse matrix */
+	double            alpha;  /* product scale */
+	double            beta;   /* output scale */
+	double           *x;      /* input components */
+	size_t            incx;   /* input increment */
+	double           *y;      /* output components */
+	size_t            incy;   /* output increment */
+	linear_matrix_t  *B;      /* input matrix */
+	linear_matrix_t  *C;      /* output matrix */
+} linear_sparse_job_t;
+
+
+static linear_sparse_t *linear_create_sparse(lua_State *L, size_t rows, size_t cols, size_t nnz);
+static inline void linear_strides(linear_matrix_t *X, size_t *rowstride, size_t *colstride);
+static int linear_spmv_kernel(void *arg, size_t start, size_t end);
+static int linear_spmm_kernel(void *arg, size_t start, size_t end);
+static int linear_sparse_tostring(lua_State *L);
+static int linear_sparse_dense(lua_State *L, linear_matrix_t *X);
+static int linear_sparse(lua_State *L);
+static int linear_spdense(lua_State *L);
+static int linear_spmv(lua_State *L);
+static int linear_spmm(lua_State *L);
+static int linear_spscal(lua_State *L);
+static int linear_spsum(lua_State *L);
+
+
+static const char *const linear_transposes[] = {"notrans", "trans", NULL};
+static const char *const linear_sides[] = {"left", "right", NULL};
+
+
+/*
+ * sparse matrix
+ */
+
+static linear_sparse_t *linear_create_sparse (lua_State *L, size_t rows, size_t cols,
+		size_t nnz) {
+	linear_sparse_t  *S;
+
+	S = lua_newuserdata(L, sizeof(linear_sparse_t) + (rows + 1 + nnz) * sizeof(size_t)
+			+ nnz * sizeof(double));
+	S->rows = rows;
+	S->cols = cols;
+	S->nnz = nnz;
+	S->rowptr = (size_t *)((char *)S + sizeof(linear_sparse_t));
+	S->colind = S->rowptr + (rows + 1);
+	S->values = (double *)(S->colind + nnz);
+	luaL_getmetatable(L, LINEAR_SPARSE);
+	lua_setmetatable(L, -2);
+	return S;
+}
+
+static inline void linear_strides (linear_matrix_t *X, size_t *rowstride, size_t *colstride) {
+	if (X->order == CblasRowMajor) {
+		*rowstride = X->ld;
+		*colstride = 1;
+	} else {
+		*rowstride = 1;
+		*colstride = X->ld;
+	}
+}
+
+static int linear_sparse_tostring (lua_State *L) {
+	linear_sparse_t  *S;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	lua_pushfstring(L, LINEAR_SPARSE ": %p", S);
+	return 1;
+}
+
+
+/*
+ * kernels
+ */
+
+static int linear_spmv_kernel (void *arg, size_t start, size_t end) {
+	size_t                i, k;
+	double                sum, *y;
+	linear_sparse_t      *S;
+	linear_sparse_job_t  *job;
+
+	job = arg;
+	S = job->S;
+	for (i = start; i < end; i++) {
+		sum = 0.0;
+		for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+			sum += S->values[k] * job->x[S->colind[k] * job->incx];
+		}
+		y = &job->y[i * job->incy];
+		*y = job->beta == 0.0 ? job->alpha * sum : job->alpha * sum + job->beta * *y;
+	}
+	return 0;
+}
+
+static int linear_spmm_kernel (void *arg, size_t start, size_t end) {
+	size_t                i, j, k, n, brs, bcs, crs, ccs;
+	double                a, *b, *c;
+	linear_sparse_t      *S;
+	linear_sparse_job_t  *job;
+
+	job = arg;
+	S = job->S;
+	n = job->C->cols;
+	linear_strides(job->B, &brs, &bcs);
+	linear_strides(job->C, &crs, &ccs);
+	for (i = start; i < end; i++) {
+		c = &job->C->values[i * crs];
+		for (j = 0; j < n; j++) {
+			c[j * ccs] = job->beta == 0.0 ? 0.0 : job->beta * c[j * ccs];
+		}
+		for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+			a = job->alpha * S->values[k];
+			b = &job->B->values[S->colind[k] * brs];
+			if (bcs == 1 && ccs == 1) {
+				for (j = 0; j < n; j++) {
+					c[j] += a * b[j];
+				}
+			} else {
+				for (j = 0; j < n; j++) {
+					c[j * ccs] += a * b[j * bcs];
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+
+/*
+ * sparse functions
+ */
+
+static int linear_sparse_dense (lua_State *L, linear_matrix_t *X) {
+	size_t            i, j, k, nnz, rs, cs;
+	double            threshold, value;
+	linear_sparse_t  *S;
+
+	threshold = luaL_optnumber(L, 2, 0.0);
+	linear_strides(X, &rs, &cs);
+	nnz = 0;
+	for (i = 0; i < X->rows; i++) {
+		for (j = 0; j < X->cols; j++) {
+			value = X->values[i * rs + j * cs];
+			if (!(fabs(value) <= threshold)) {
+				nnz++;
+			}
+		}
+	}
+	S = linear_create_sparse(L, X->rows, X->cols, nnz);
+	k = 0;
+	for (i = 0; i < X->rows; i++) {
+		S->rowptr[i] = k;
+		for (j = 0; j < X->cols; j++) {
+			value = X->values[i * rs + j * cs];
+			if (!(fabs(value) <= threshold)) {
+				S->colind[k] = j;
+				S->values[k] = value;
+				k++;
+			}
+		}
+	}
+	S->rowptr[X->rows] = k;
+	return 1;
+}
+
+static int linear_sparse (lua_State *L) {
+	size_t            rows, cols, n, t, k, r, c, nnz, *rowind, *colind, *count, *bycol,
+			*byrow;
+	double            ri, ci;
+	linear_vector_t  *i, *j, *v;
+	linear_matrix_t  *X;
+	linear_sparse_t  *S;
+
+	/* dense matrix */
+	X = luaL_testudata(L, 1, LINEAR_MATRIX);
+	if (X != NULL) {
+		return linear_sparse_dense(L, X);
+	}
+
+	/* check arguments */
+	rows = luaL_checkinteger(L, 1);
+	luaL_argcheck(L, rows >= 1 && rows <= INT_MAX, 1, "bad dimension");
+	cols = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, cols >= 1 && cols <= INT_MAX, 2, "bad dimension");
+	i = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	j = luaL_checkudata(L, 4, LINEAR_VECTOR);
+	luaL_argcheck(L, j->length == i->length, 4, "dimension mismatch");
+	v = luaL_checkudata(L, 5, LINEAR_VECTOR);
+	luaL_argcheck(L, v->length == i->length, 5, "dimension mismatch");
+	n = i->length;
+
+	/* convert indexes */
+	rowind = malloc((4 * n + (rows > cols ? rows : cols) + 1) * sizeof(size_t));
+	if (rowind == NULL) {
+		return luaL_error(L, "cannot allocate indexes");
+	}
+	colind = rowind + n;
+	bycol = colind + n;
+	byrow = bycol + n;
+	count = byrow + n;
+	for (t = 0; t < n; t++) {
+		ri = i->values[t * i->inc];
+		ci = j->values[t * j->inc];
+		if (!(ri >= 1 && ri <= rows && ri == floor(ri) && ci >= 1 && ci <= cols
+				&& ci == floor(ci))) {
+			free(rowind);
+			return luaL_error(L, "bad index at index %d", (int)(t + 1));
+		}
+		rowind[t] = (size_t)ri - 1;
+		colind[t] = (size_t)ci - 1;
+	}
+
+	/* sort the triplets by column, and then stably by row (counting sorts) */
+	memset(count, 0, (cols + 1) * sizeof(size_t));
+	for (t = 0; t < n; t++) {
+		count[colind[t] + 1]++;
+	}
+	for (c = 0; c < cols; c++) {
+		count[c + 1] += count[c];
+	}
+	for (t = 0; t < n; t++) {
+		bycol[count[colind[t]]++] = t;
+	}
+	memset(count, 0, (rows + 1) * sizeof(size_t));
+	for (t = 0; t < n; t++) {
+		count[rowind[t] + 1]++;
+	}
+	for (r = 0; r < rows; r++) {
+		count[r + 1] += count[r];
+	}
+	for (t = 0; t < n; t++) {
+		byrow[count[rowind[bycol[t]]]++] = bycol[t];
+	}
+
+	/* count the unique elements, and make the sparse matrix, summing duplicates */
+	nnz = 0;
+	for (t = 0; t < n; t++) {
+		if (t == 0 || rowind[byrow[t]] != rowind[byrow[t - 1]]
+				|| colind[byrow[t]] != colind[byrow[t - 1]]) {
+			nnz++;
+		}
+	}
+	S = linear_create_sparse(L, rows, cols, nnz);
+	k = 0;
+	r = 0;
+	S->rowptr[0] = 0;
+	for (t = 0; t < n; t++) {
+		while (r < rowind[byrow[t]]) {
+			S->rowptr[++r] = k;
+		}
+		if (k > S->rowptr[r] && S->colind[k - 1] == colind[byrow[t]]) {
+			S->values[k - 1] += v->values[byrow[t] * v->inc];
+		} else {
+			S->colind[k] = colind[byrow[t]];
+			S->values[k] = v->values[byrow[t] * v->inc];
+			k++;
+		}
+	}
+	while (r < rows) {
+		S->rowptr[++r] = k;
+	}
+	free(rowind);
+	return 1;
+}
+
+static int linear_spdense (lua_State *L) {
+	size_t            i, j, k, rs, cs;
+	linear_sparse_t  *S;
+	linear_matrix_t  *X;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	X = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	luaL_argcheck(L, X->rows == S->rows && X->cols == S->cols, 2, "dimension mismatch");
+	linear_strides(X, &rs, &cs);
+	for (i = 0; i < S->rows; i++) {
+		for (j = 0; j < S->cols; j++) {
+			X->values[i * rs + j * cs] = 0.0;
+		}
+		for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+			X->values[i * rs + S->colind[k] * cs] = S->values[k];
+		}
+	}
+	return 0;
+}
+
+static int linear_spmv (lua_State *L) {
+	int                   trans;
+	size_t                i, k;
+	double                xi;
+	linear_sparse_t      *S;
+	linear_vector_t      *x, *y;
+	linear_sparse_job_t   job;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	x = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	y = luaL_checkudata(L, 3, LINEAR_VECTOR);
+	trans = luaL_checkoption(L, 4, "notrans", linear_transposes);
+	luaL_argcheck(L, x->length == (!trans ? S->cols : S->rows), 2, "dimension mismatch");
+	luaL_argcheck(L, y->length == (!trans ? S->rows : S->cols), 3, "dimension mismatch");
+	job.S = S;
+	job.alpha = luaL_optnumber(L, 5, 1.0);
+	job.beta = luaL_optnumber(L, 6, 0.0);
+	job.x = x->values;
+	job.incx = x->inc;
+	job.y = y->values;
+	job.incy = y->inc;
+	if (!trans) {
+		linear_parallel(linear_spmv_kernel, &job, S->rows, S->rowptr, S->nnz);
+	} else {
+		/* scatter into the columns */
+		for (i = 0; i < y->length; i++) {
+			y->values[i * y->inc] = job.beta == 0.0 ? 0.0 : job.beta
+					* y->values[i * y->inc];
+		}
+		for (i = 0; i < S->rows; i++) {
+			xi = job.alpha * x->values[i * x->inc];
+			for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+				y->values[S->colind[k] * y->inc] += S->values[k] * xi;
+			}
+		}
+	}
+	return 0;
+}
+
+static int linear_spmm (lua_State *L) {
+	int                   trans;
+	size_t                i, j, k, n, brs, bcs, crs, ccs;
+	double                a, *b, *c;
+	linear_sparse_t      *S;
+	linear_matrix_t      *B, *C;
+	linear_sparse_job_t   job;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	B = luaL_checkudata(L, 2, LINEAR_MATRIX);
+	C = luaL_checkudata(L, 3, LINEAR_MATRIX);
+	trans = luaL_checkoption(L, 4, "notrans", linear_transposes);
+	luaL_argcheck(L, B->rows == (!trans ? S->cols : S->rows), 2, "dimension mismatch");
+	luaL_argcheck(L, C->rows == (!trans ? S->rows : S->cols) && C->cols == B->cols, 3,
+			"dimension mismatch");
+	job.S = S;
+	job.alpha = luaL_optnumber(L, 5, 1.0);
+	job.beta = luaL_optnumber(L, 6, 0.0);
+	job.B = B;
+	job.C = C;
+	if (!trans) {
+		linear_parallel(linear_spmm_kernel, &job, S->rows, S->rowptr, S->nnz);
+	} else {
+		/* scatter into the rows of C */
+		n = C->cols;
+		linear_strides(B, &brs, &bcs);
+		linear_strides(C, &crs, &ccs);
+		for (i = 0; i < C->rows; i++) {
+			for (j = 0; j < n; j++) {
+				c = &C->values[i * crs + j * ccs];
+				*c = job.beta == 0.0 ? 0.0 : job.beta * *c;
+			}
+		}
+		for (i = 0; i < S->rows; i++) {
+			b = &B->values[i * brs];
+			for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+				a = job.alpha * S->values[k];
+				c = &C->values[S->colind[k] * crs];
+				for (j = 0; j < n; j++) {
+					c[j * ccs] += a * b[j * bcs];
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+static int linear_spscal (lua_State *L) {
+	size_t            i, k;
+	double            xi;
+	linear_sparse_t  *S;
+	linear_vector_t  *x;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	x = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	if (luaL_checkoption(L, 3, "left", linear_sides) == 0) {
+		luaL_argcheck(L, x->length == S->rows, 2, "dimension mismatch");
+		for (i = 0; i < S->rows; i++) {
+			xi = x->values[i * x->inc];
+			for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+				S->values[k] *= xi;
+			}
+		}
+	} else {
+		luaL_argcheck(L, x->length == S->cols, 2, "dimension mismatch");
+		for (k = 0; k < S->nnz; k++) {
+			S->values[k] *= x->values[S->colind[k] * x->inc];
+		}
+	}
+	return 0;
+}
+
+static int linear_spsum (lua_State *L) {
+	size_t            i, k;
+	double            sum;
+	linear_sparse_t  *S;
+	linear_vector_t  *y;
+
+	S = luaL_checkudata(L, 1, LINEAR_SPARSE);
+	y = luaL_checkudata(L, 2, LINEAR_VECTOR);
+	if (linear_checkorder(L, 3) == CblasRowMajor) {
+		luaL_argcheck(L, y->length == S->rows, 2, "dimension mismatch");
+		for (i = 0; i < S->rows; i++) {
+			sum = 0.0;
+			for (k = S->rowptr[i]; k < S->rowptr[i + 1]; k++) {
+				sum += S->values[k];
+			}
+			y->values[i * y->inc] = sum;
+		}
+	} else {
+		luaL_argcheck(L, y->length == S->cols, 2, "dimension mismatch");
+		for (i = 0; i < S->cols; i++) {
+			y->values[i * y->inc] = 0.0;
+		}
+		for (k = 0; k < S->nnz; k++) {
+			y->values[S->colind[k] * y->inc] += S->values[k];
+		}
+	}
+	return 0;
+}
+
+int linear_open_sparse (lua_State *L) {
+	static const luaL_Reg functions[] = {
+		{"sparse", linear_sparse},
+		{"spdense", linear_spdense},
+		{"spmv", linear_spmv},
+		{"spmm", linear_spmm},
+		{"spscal", linear_spscal},
+		{"spsum", linear_spsum},
+		{NULL, NULL}
+	};
+	linear_profile_setfuncs(L, functions);
+
+	/* sparse matrix metatable */
+	luaL_newmetatable(L, LINEAR_SPARSE);
+	lua_pushcfunction(L, linear_sparse_tostring);
+	lua_setfield(L, -2, "__tostring");
+	lua_pop(L, 1);
+
+	return 0;
+}
@@ -0,0 +1,18 @@
+/*
+ * Lua Linear sparse matrix functions
+ *
+ * Copyright (C) 2017-2023 Andre Naef
+ */
+
+
+#ifndef _LINEAR_SPARSE_INCLUDED
+#define _LINEAR_SPARSE_INCLUDED
+
+
+#include <lua.h>
+
+
+int linear_open_sparse(lua_State *L);
+
+
+#endif /* _LINEAR_SPARSE_INCLUDED */
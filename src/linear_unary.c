@@ -17,6 +17,7 @@
 #endif
 
 
+static int linear_unary_call(lua_State *L, linear_unary_function f, linear_param_t *params);
 static double linear_sum_handler(size_t size, double *values, size_t inc, linear_arg_u *args);
 static int linear_sum(lua_State *L);
 static double linear_mean_handler(size_t size, double *values, size_t inc, linear_arg_u *args);
@@ -62,6 +63,19 @@ static linear_param_t linear_params_lua[] = {
 
 
 int linear_unary (lua_State *L, linear_unary_function f, linear_param_t *params) {
+	int                    results;
+	linear_profile_call_t  call;
+
+	if (!linear_isprofiling()) {
+		return linear_unary_call(L, f, params);
+	}
+	linear_profile_start(L, 1, &call);
+	results = linear_unary_call(L, f, params);
+	linear_profile_stop(L, &call);
+	return results;
+}
+
+static int linear_unary_call (lua_State *L, linear_unary_function f, linear_param_t *params) {
 	size_t            i;
 	linear_arg_u      args[LINEAR_PARAMS_MAX];
 	linear_vector_t  *x, *y;
@@ -285,7 +299,10 @@ static double linear_median_handler (size_t size, double *x, size_t incx, linear
 		s[i] = *x;
 		x += incx;
 	}
-	qsort(s, size, sizeof(double), linear_comparison_handler);
+	if (linear_radixsort(s, 1, s, 1, size, 0) != 0) {
+		free(s);
+		return luaL_error(args[0].L, "cannot allocate components");
+	}
 	mid = size / 2;
 	median = size % 2 == 0 ? (s[mid - 1] + s[mid]) / 2 : s[mid];
 	free(s);
@@ -313,7 +330,10 @@ static double linear_mad_handler (size_t size, double *x, size_t incx, linear_ar
 		s[i] = *x;
 		x += incx;
 	}
-	qsort(s, size, sizeof(double), linear_comparison_handler);
+	if (linear_radixsort(s, 1, s, 1, size, 0) != 0) {
+		free(s);
+		return luaL_error(args[0].L, "cannot allocate components");
+	}
 	mid = size / 2;
 	median = size % 2 == 0 ? (s[mid - 1] + s[mid]) / 2 : s[mid];
 
@@ -321,7 +341,10 @@ static double linear_mad_handler (size_t size, double *x, size_t incx, linear_ar
 	for (i = 0; i < size; i++) {
 		s[i] = fabs(s[i] - median);
 	}
-	qsort(s, size, sizeof(double), linear_comparison_handler);
+	if (linear_radixsort(s, 1, s, 1, size, 0) != 0) {
+		free(s);
+		return luaL_error(args[0].L, "cannot allocate components");
+	}
 	mad = size % 2 == 0 ? (s[mid - 1] + s[mid]) / 2 : s[mid];
 	free(s);
 	return mad;
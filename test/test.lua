@@ -273,6 +273,175 @@ local function testRandomseed ()
 	test(os.time())
 end
 
+-- Tests the rng function
+local function testRng ()
+	local rng = linear.rng(42)
+	assert(linear.type(rng) == "rng")
+	assert(tostring(rng):match("^linear.rng: "))
+	assert(linear.uniform(0, rng) == 0.08575559529546095)
+	local clone = rng:clone()
+	assert(linear.uniform(0, rng) == 0.31041139572710486)
+	assert(linear.uniform(0, clone) == 0.31041139572710486)
+	rng = linear.rng(42)
+	rng:jump()
+	assert(linear.uniform(0, rng) == 0.6446590718161198)
+	rng = linear.rng(42)
+	rng:longjump()
+	assert(linear.uniform(0, rng) == 0.9663376685567177)
+
+	-- reproducible streams
+	local x, y = linear.vector(10), linear.vector(10)
+	linear.normal(x, linear.rng(7))
+	linear.normal(y, linear.rng(7))
+	for i = 1, 10 do
+		assert(x[i] == y[i])
+	end
+	local a, b = linear.rng(), linear.rng()
+	linear.uniform(x, a)
+	linear.uniform(y, b)
+	assert(x[1] ~= y[1])
+	assert(not pcall(linear.uniform, x, {}))
+
+	-- counter-based streams
+	rng = linear.rng(42, "philox")
+	assert(linear.type(rng) == "rng")
+	assert(rng:tell() == 0)
+	assert(linear.uniform(0, rng) == 0.4685865183391049)
+	assert(rng:tell() == 1)
+	rng:seek(1000)
+	assert(linear.uniform(0, rng) == 0.6807365074709664)
+	rng:seek(5, 3)
+	assert(linear.uniform(0, rng) == 0.18618484545159897)
+	rng = linear.rng(42, "philox")
+	rng:jump()
+	rng:jump()
+	rng:jump()
+	rng:seek(5)
+	assert(linear.uniform(0, rng) == 0.18618484545159897)
+	assert(not pcall(linear.rng(42).seek, linear.rng(42), 0))
+	assert(not pcall(rng.seek, rng, -1))
+	assert(not pcall(linear.rng, 42, "other"))
+
+	-- counter-based fills are independent of how the work is split
+	for _, f in ipairs({ linear.uniform, linear.normal }) do
+		local X, Y = linear.matrix(40, 50), linear.matrix(40, 50)
+		f(X, linear.rng(7, "philox"))
+		rng = linear.rng(7, "philox")
+		for i = 40, 1, -1 do
+			local part = rng:clone()
+			part:seek((i - 1) * 50)
+			f(Y[i], part)
+		end
+		for i = 1, 40 do
+			for j = 1, 50 do
+				assert(X[i][j] == Y[i][j])
+			end
+		end
+	end
+	x = linear.vector(100000)
+	linear.normal(x, linear.rng(7, "philox"))
+	assert(math.abs(linear.mean(x)) < 0.020)
+	assert(math.abs(linear.std(x, 1) - 1.0) < 0.012)
+end
+
+local function testProfile ()
+	local x, X = linear.vector(5), linear.matrix(4, 3)
+	local y = linear.vector(5)
+
+	-- disabled
+	linear.profile(true)
+	linear.profile(false)
+	linear.scal(x, 2)
+	assert(next(linear.profile()) == nil)
+
+	-- enabled
+	linear.profile(true)
+	linear.scal(x, 2)
+	linear.scal(X, 2)
+	assert(linear.scal(3, 2) == 6)
+	linear.sum(x)
+	linear.axpy(x, y)
+	linear.dot(x, y)
+	assert(not pcall(linear.scal, {}))
+	linear.profile(false)
+	local profile = linear.profile()
+	assert(profile.scal.count == 3)
+	assert(profile.scal.elements == 18)
+	assert(profile.scal.time >= 0)
+	assert(profile.scal.histogram[1] == 1)
+	assert(profile.scal.histogram[8] == 1)
+	assert(profile.scal.histogram[16] == 1)
+	assert(profile.sum.count == 1 and profile.sum.elements == 5)
+	assert(profile.axpy.count == 1 and profile.axpy.elements == 5)
+	assert(profile.dot.count == 1 and profile.dot.elements == 5)
+
+	-- sparse
+	local S = linear.sparse(linear.tolinear({ { 1, 0, 2 }, { 0, 3, 0 } }))
+	local u, v = linear.vector(3), linear.vector(2)
+	linear.profile(true)
+	linear.spmv(S, u, v)
+	linear.profile(false)
+	profile = linear.profile()
+	assert(profile.spmv.count == 1 and profile.spmv.elements == 3)
+
+	-- aliases and restart
+	local scal = linear.scal
+	linear.profile(true)
+	scal(x)
+	profile = linear.profile()
+	linear.profile(false)
+	assert(profile.scal.count == 1)
+	assert(profile.sum == nil)
+	assert(not pcall(linear.profile, 1))
+
+	-- hardware counters, where available
+	local counting = linear.profile(true, true)
+	linear.scal(x)
+	linear.profile(false)
+	profile = linear.profile()
+	if counting then
+		assert(profile.scal.instructions == nil or profile.scal.instructions > 0)
+	else
+		assert(profile.scal.cycles == nil and profile.scal.instructions == nil)
+	end
+	assert(linear.profile(true) == false)
+	linear.profile(false)
+end
+
+local function testTrace ()
+	local x, X = linear.vector(5), linear.matrix(4, 3)
+	local S = linear.sparse(linear.tolinear({ { 1, 0, 2 }, { 0, 3, 0 } }))
+	local u, v = linear.vector(3), linear.vector(2)
+	local path = os.tmpname()
+
+	-- ring buffer of four events
+	linear.trace(true, 4)
+	linear.scal(x, 2)
+	linear.scal(X, 2)
+	linear.sum(x)
+	linear.dot(x, x)
+	assert(linear.exp(0) == 1)
+	linear.spmv(S, u, v)
+	linear.trace(false)
+	linear.scal(x)
+	assert(linear.trace_dump(path) == 4)
+	local file = assert(io.open(path))
+	local trace = file:read("*a")
+	file:close()
+	os.remove(path)
+	assert(trace:match('^{"traceEvents":%['))
+	local names, shapes = {}, {}
+	for name, shape in trace:gmatch('"name":"(%w+)".-"shape":(%[[%d,]*%])') do
+		table.insert(names, name)
+		table.insert(shapes, shape)
+	end
+	assert(table.concat(names, " ") == "sum dot exp spmv")
+	assert(table.concat(shapes, " ") == "[5] [5] [] [2,3]")
+	assert(trace:match('"ph":"X","ts":[%d.]+,"dur":[%d.]+,"pid":%d+,"tid":%d+'))
+	assert(not pcall(linear.trace, true, 0))
+	assert(not pcall(linear.trace_dump, "/nonexistent/trace.json"))
+end
+
 
 --
 -- Elementary functions
@@ -437,8 +606,29 @@ local function testUniform ()
 	end
 	local x = linear.vector(100000)
 	linear.uniform(x)
+	for i = 1, #x do
+		assert(x[i] >= 0 and x[i] < 1)
+	end
 	assert(math.abs(linear.mean(x) - 0.5) < 0.005)
 	assert(math.abs(linear.var(x, 1) - 1 / 12) < 0.001)
+	local y = linear.vector(100000)
+	linear.uniform(x, linear.rng(7))
+	linear.uniform(y, linear.rng(7))
+	assert(x[1] == y[1] and x[50001] == y[50001] and x[100000] == y[100000])
+
+	-- the sequence depends on the fill size and layout; lanes from 1024 contiguous values
+	x = linear.vector(1024)
+	linear.uniform(x, linear.rng(42))
+	assert(x[1] == 0.54704427907691588 and x[1024] == 0.80039141134631575)
+	x = linear.vector(1023)
+	linear.uniform(x, linear.rng(42))
+	assert(x[1] == 0.08575559529546095)
+	local X = linear.matrix(32, 32)
+	linear.uniform(X, linear.rng(42))
+	assert(X[1][1] == 0.54704427907691588 and X[32][32] == 0.80039141134631575)
+	X = linear.sub(linear.matrix(32, 64), 1, 1, 32, 32)
+	linear.uniform(X, linear.rng(42))
+	assert(X[1][1] == 0.08575559529546095 and X[2][1] == 0.69987867843589435)
 end
 
 -- Tests the normal function
@@ -460,6 +650,18 @@ local function testNormal ()
 	linear.normal(x)
 	assert(math.abs(linear.mean(x) - 0.0) < 0.020)
 	assert(math.abs(linear.std(x, 1) - 1.0) < 0.012)
+	local outer, tail = 0, 0
+	for i = 1, #x do
+		local a = math.abs(x[i])
+		if a > 2 then
+			outer = outer + 1
+		end
+		if a > 3.5 then
+			tail = tail + 1
+		end
+	end
+	assert(math.abs(outer / #x - 0.0455) < 0.003)
+	assert(tail > 10 and tail < 100)
 end
 
 -- Test the normal PDF
@@ -484,6 +686,93 @@ local function testNormalQf ()
 	assert(math.abs(linear.normalqf(0.841345) - 1) < EPSILON)
 	assert(math.abs(linear.normalqf(0.066807, 2.5) - 1) < EPSILON)
 	assert(math.abs(linear.normalqf(0.158655, 2.5, 1.5) - 1) < EPSILON)
+	assert(math.abs(linear.normalcdf(linear.normalqf(0.98031429756720856))
+			- 0.98031429756720856) < EPSILON)
+end
+
+-- Checks the mean and variance of random values
+local function checkMoments (x, mean, var, tolerance)
+	assert(math.abs(linear.mean(x) - mean) < tolerance * math.sqrt(var / #x))
+	assert(math.abs(linear.var(x, 1) - var) < tolerance * var * 0.02)
+end
+
+-- Tests the exponential function
+local function testExponential ()
+	assert(linear.exponential(0) >= 0)
+	local x = linear.vector(100000)
+	linear.exponential(x, 2, linear.rng(1))
+	for i = 1, #x do
+		assert(x[i] >= 0)
+	end
+	checkMoments(x, 0.5, 0.25, 5)
+	local A = linear.matrix(3, 3)
+	linear.exponential(A)
+	assert(A[3][3] >= 0)
+	assert(not pcall(linear.exponential, x, 0))
+end
+
+-- Tests the gamma function
+local function testGamma ()
+	local x = linear.vector(100000)
+	linear.gamma(x, 3, 2, linear.rng(1))
+	checkMoments(x, 6, 12, 5)
+	linear.gamma(x, 0.5, 1, linear.rng(2))
+	for i = 1, #x do
+		assert(x[i] >= 0)
+	end
+	checkMoments(x, 0.5, 0.5, 5)
+	assert(not pcall(linear.gamma, x, 0))
+	assert(not pcall(linear.gamma, x, 1, -1))
+end
+
+-- Tests the beta function
+local function testBeta ()
+	local x = linear.vector(100000)
+	linear.beta(x, 2, 5, linear.rng(1))
+	for i = 1, #x do
+		assert(x[i] >= 0 and x[i] <= 1)
+	end
+	checkMoments(x, 2 / 7, 10 / (49 * 8), 5)
+	assert(not pcall(linear.beta, x, 1, 0))
+end
+
+-- Tests the Poisson function
+local function testPoisson ()
+	local x = linear.vector(100000)
+	for _, lambda in ipairs({ 0.5, 4, 30, 1000 }) do
+		linear.poisson(x, lambda, linear.rng(1))
+		for i = 1, #x do
+			assert(x[i] >= 0 and x[i] == math.floor(x[i]))
+		end
+		checkMoments(x, lambda, lambda, 5)
+	end
+	assert(linear.poisson(0, 0) == 0)
+	assert(not pcall(linear.poisson, x, -1))
+end
+
+-- Tests the binomial function
+local function testBinomial ()
+	local x = linear.vector(100000)
+	for _, case in ipairs({ { 10, 0.3 }, { 20, 0.9 }, { 100, 0.4 }, { 100000, 0.7 } }) do
+		local n, p = case[1], case[2]
+		linear.binomial(x, n, p, linear.rng(1))
+		for i = 1, #x do
+			assert(x[i] >= 0 and x[i] <= n and x[i] == math.floor(x[i]))
+		end
+		checkMoments(x, n * p, n * p * (1 - p), 5)
+	end
+	assert(linear.binomial(0, 5, 0) == 0)
+	assert(linear.binomial(0, 5, 1) == 5)
+	assert(not pcall(linear.binomial, x, -1))
+	assert(not pcall(linear.binomial, x, 1, 1.5))
+end
+
+-- Tests the Student's t function
+local function testStudentT ()
+	local x = linear.vector(100000)
+	linear.studentt(x, 10, linear.rng(1))
+	checkMoments(x, 0, 1.25, 5)
+	assert(not pcall(linear.studentt, x, 0))
 end
 
 
@@ -746,6 +1035,22 @@ local function testAxpby ()
 	assert(Y[1][2] == 6)
 	assert(Y[2][1] == 3)
 	assert(Y[2][2] == 5)
+
+	-- matrix-matrix, mixed order
+	local X = linear.matrix(70, 3, "col")
+	local Y = linear.matrix(70, 3)
+	for i = 1, 70 do
+		for j = 1, 3 do
+			X[j][i] = i * 10 + j
+			Y[i][j] = 1
+		end
+	end
+	linear.axpby(X, Y, 1, 2)
+	for i = 1, 70 do
+		for j = 1, 3 do
+			assert(Y[i][j] == i * 10 + j + 2)
+		end
+	end
 end
 
 -- Tests the mul function
@@ -884,6 +1189,232 @@ local function testGemm ()
 	assert(C3[1] == 30)
 	assert(C3[2] == 66)
 	assert(C3[3] == 102)
+
+	-- mixed order
+	local B = linear.tolinear({ { 1, 3, 5 }, { 2, 4, 6 } }, "col")
+	local C = linear.matrix(2, 2, "col")
+	linear.gemm(A, B, C)
+	assert(C[1][1] == 22)
+	assert(C[2][1] == 28)
+	assert(C[1][2] == 49)
+	assert(C[2][2] == 64)
+	local C = linear.matrix(2, 2)
+	linear.gemm(B, A, C, "trans", "trans")
+	assert(C[1][1] == 22)
+	assert(C[1][2] == 49)
+	assert(C[2][1] == 28)
+	assert(C[2][2] == 64)
+end
+
+-- Tests the trmv function
+local function testTrmv ()
+	local A = linear.tolinear({ { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } })
+	local x = linear.tolinear({ 1, 2, 3 })
+	linear.trmv(A, x)
+	assert(x[1] == 14)
+	assert(x[2] == 28)
+	assert(x[3] == 27)
+	x = linear.tolinear({ 1, 2, 3 })
+	linear.trmv(A, x, "lower", "notrans", "unit")
+	assert(x[1] == 1)
+	assert(x[2] == 6)
+	assert(x[3] == 26)
+	x = linear.tolinear({ 1, 2, 3 })
+	linear.trmv(A, x, "upper", "trans")
+	assert(x[1] == 1)
+	assert(x[2] == 12)
+	assert(x[3] == 42)
+end
+
+-- Tests the trsv function
+local function testTrsv ()
+	local A = linear.tolinear({ { 2, 1, 1 }, { 0, 4, 2 }, { 0, 0, 5 } })
+	local x = linear.tolinear({ 9.5, 16, 15 })
+	linear.trsv(A, x)
+	assert(math.abs(x[1] - 2) < EPSILON)
+	assert(math.abs(x[2] - 2.5) < EPSILON)
+	assert(math.abs(x[3] - 3) < EPSILON)
+	x = linear.tolinear({ 2, 5, 13 })
+	linear.trsv(A, x, "upper", "trans")
+	assert(math.abs(x[1] - 1) < EPSILON)
+	assert(math.abs(x[2] - 1) < EPSILON)
+	assert(math.abs(x[3] - 2) < EPSILON)
+end
+
+-- Tests the trmm function
+local function testTrmm ()
+	local A = linear.tolinear({ { 1, 2 }, { 3, 4 } })
+	local B = linear.tolinear({ { 1, 1, 1 }, { 1, 2, 3 } })
+	linear.trmm(A, B)
+	assert(B[1][1] == 3)
+	assert(B[1][2] == 5)
+	assert(B[1][3] == 7)
+	assert(B[2][1] == 4)
+	assert(B[2][2] == 8)
+	assert(B[2][3] == 12)
+	B = linear.tolinear({ { 1, 1 }, { 1, 2 } })
+	linear.trmm(A, B, "right", "lower", nil, nil, 2)
+	assert(B[1][1] == 8)
+	assert(B[1][2] == 8)
+	assert(B[2][1] == 14)
+	assert(B[2][2] == 16)
+end
+
+-- Tests the trsm function
+local function testTrsm ()
+	local A = linear.tolinear({ { 1, 2 }, { 3, 4 } })
+	local B = linear.tolinear({ { 3, 5, 7 }, { 4, 8, 12 } })
+	linear.trsm(A, B)
+	assert(math.abs(B[1][1] - 1) < EPSILON)
+	assert(math.abs(B[1][2] - 1) < EPSILON)
+	assert(math.abs(B[1][3] - 1) < EPSILON)
+	assert(math.abs(B[2][1] - 1) < EPSILON)
+	assert(math.abs(B[2][2] - 2) < EPSILON)
+	assert(math.abs(B[2][3] - 3) < EPSILON)
+	B = linear.tolinear({ { 8, 8 }, { 14, 16 } })
+	linear.trsm(A, B, "right", "lower", nil, nil, 0.5)
+	assert(math.abs(B[1][1] - 1) < EPSILON)
+	assert(math.abs(B[1][2] - 1) < EPSILON)
+	assert(math.abs(B[2][1] - 1) < EPSILON)
+	assert(math.abs(B[2][2] - 2) < EPSILON)
+
+	-- mixed order
+	B = linear.tolinear({ { 3, 4 }, { 5, 8 }, { 7, 12 } }, "col")
+	linear.trsm(A, B)
+	assert(math.abs(B[1][1] - 1) < EPSILON)
+	assert(math.abs(B[1][2] - 1) < EPSILON)
+	assert(math.abs(B[2][1] - 1) < EPSILON)
+	assert(math.abs(B[2][2] - 2) < EPSILON)
+	assert(math.abs(B[3][1] - 1) < EPSILON)
+	assert(math.abs(B[3][2] - 3) < EPSILON)
+end
+
+-- Tests the syr function
+local function testSyr ()
+	local x = linear.tolinear({ 1, 2 })
+	local A = linear.matrix(2, 2)
+	linear.syr(x, A, nil, 2)
+	assert(A[1][1] == 2)
+	assert(A[1][2] == 4)
+	assert(A[2][1] == 0)
+	assert(A[2][2] == 8)
+	linear.syr(x, A, "lower")
+	assert(A[1][2] == 4)
+	assert(A[2][1] == 2)
+	assert(A[2][2] == 12)
+end
+
+-- Tests the symv function
+local function testSymv ()
+	local A = linear.tolinear({ { 1, 2 }, { -1, 3 } })
+	local x = linear.tolinear({ 1, 2 })
+	local y = linear.tolinear({ 1, 1 })
+	linear.symv(A, x, y, nil, 2, 1)
+	assert(y[1] == 11)
+	assert(y[2] == 17)
+	linear.symv(A, x, y, "lower")
+	assert(y[1] == -1)
+	assert(y[2] == 5)
+end
+
+-- Tests the symm function
+local function testSymm ()
+	local A = linear.tolinear({ { 1, 2 }, { 0, 3 } })
+	local B = linear.tolinear({ { 1, 0, 1 }, { 0, 1, 1 } })
+	local C = linear.matrix(2, 3)
+	linear.symm(A, B, C)
+	assert(C[1][1] == 1)
+	assert(C[1][2] == 2)
+	assert(C[1][3] == 3)
+	assert(C[2][1] == 2)
+	assert(C[2][2] == 3)
+	assert(C[2][3] == 5)
+	B = linear.tolinear({ { 1, 1 } })
+	C = linear.matrix(1, 2)
+	linear.symm(A, B, C, "right")
+	assert(C[1][1] == 3)
+	assert(C[1][2] == 5)
+
+	-- mixed orders; A is not symmetric, so that the referenced triangle shows
+	local function matrix (t, order)
+		local X = linear.matrix(#t, #t[1], order)
+		for i = 1, #t do
+			for j = 1, #t[1] do
+				if order == "row" then
+					X[i][j] = t[i][j]
+				else
+					X[j][i] = t[i][j]
+				end
+			end
+		end
+		return X
+	end
+	local function get (X, i, j)
+		local _, _, order = linear.size(X)
+		return order == "row" and X[i][j] or X[j][i]
+	end
+	local a = { { 1, 2 }, { 4, 3 } }
+	local bl, br = { { 1, 0, 1 }, { 2, 1, 1 } }, { { 1, 2 }, { 0, 1 }, { 1, 1 } }
+	for _, aorder in ipairs({ "row", "col" }) do
+		for _, border in ipairs({ "row", "col" }) do
+			for _, uplo in ipairs({ "upper", "lower" }) do
+				local sa = uplo == "upper" and { { 1, 2 }, { 2, 3 } } or { { 1, 4 }, { 4, 3 } }
+				A = matrix(a, aorder)
+				B = matrix(bl, border)
+				C = linear.matrix(2, 3, border)
+				linear.symm(A, B, C, "left", uplo)
+				for i = 1, 2 do
+					for j = 1, 3 do
+						assert(get(C, i, j) == sa[i][1] * bl[1][j] + sa[i][2] * bl[2][j])
+					end
+				end
+				B = matrix(br, border)
+				C = linear.matrix(3, 2, border)
+				linear.symm(A, B, C, "right", uplo)
+				for i = 1, 3 do
+					for j = 1, 2 do
+						assert(get(C, i, j) == br[i][1] * sa[1][j] + br[i][2] * sa[2][j])
+					end
+				end
+			end
+		end
+	end
+end
+
+-- Tests the syrk function
+local function testSyrk ()
+	local A = linear.tolinear({ { 1, 2 }, { 3, 4 }, { 5, 6 } })
+	local C = linear.matrix(2, 2)
+	linear.syrk(A, C, "upper", "trans")
+	assert(C[1][1] == 35)
+	assert(C[1][2] == 44)
+	assert(C[2][1] == 0)
+	assert(C[2][2] == 56)
+	C = linear.matrix(3, 3)
+	linear.syrk(A, C, "lower", nil, 2)
+	assert(C[1][1] == 10)
+	assert(C[2][1] == 22)
+	assert(C[3][1] == 34)
+	assert(C[1][2] == 0)
+	assert(C[3][3] == 122)
+	C = linear.matrix(2, 2, "col")
+	linear.syrk(A, C, "upper", "trans")
+	assert(C[1][1] == 35)
+	assert(C[2][1] == 44)
+	assert(C[1][2] == 0)
+	assert(C[2][2] == 56)
+end
+
+-- Tests the syr2k function
+local function testSyr2k ()
+	local A = linear.tolinear({ { 1, 0 }, { 0, 1 } })
+	local B = linear.tolinear({ { 1, 2 }, { 3, 4 } })
+	local C = linear.matrix(2, 2)
+	linear.syr2k(A, B, C)
+	assert(C[1][1] == 2)
+	assert(C[1][2] == 5)
+	assert(C[2][1] == 0)
+	assert(C[2][2] == 8)
 end
 
 -- Tests the gesv function
@@ -908,6 +1439,88 @@ local function testGels ()
 	assert(math.abs(B[3][1] - 0) < EPSILON)
 end
 
+-- Tests the gtsv function
+local function testGtsv ()
+	local dl, d, du = linear.tolinear({ -1, -1 }), linear.tolinear({ 2, 2, 2 }),
+			linear.tolinear({ -1, -1 })
+	local b = linear.tolinear({ 0, 0, 4 })
+	assert(linear.gtsv(dl, d, du, b) == true)
+	assert(math.abs(b[1] - 1) < EPSILON)
+	assert(math.abs(b[2] - 2) < EPSILON)
+	assert(math.abs(b[3] - 3) < EPSILON)
+	assert(d[1] == 2 and dl[1] == -1 and du[1] == -1)
+	local B = linear.tolinear({ { 0, 1 }, { 0, 0 }, { 4, 1 } })
+	assert(linear.gtsv(dl, d, du, B) == true)
+	assert(math.abs(B[3][1] - 3) < EPSILON)
+	assert(math.abs(B[2][2] - 1) < EPSILON)
+	B = linear.tolinear({ { 0, 0, 4 }, { 1, 0, 1 } }, "col")
+	assert(linear.gtsv(dl, d, du, B) == true)
+	assert(math.abs(B[1][1] - 1) < EPSILON)
+	assert(math.abs(B[2][3] - 1) < EPSILON)
+	b = linear.tvector(linear.tolinear({ { 0, 9 }, { 0, 9 }, { 4, 9 } }), 1)
+	assert(linear.gtsv(dl, d, du, b) == true)
+	assert(math.abs(b[2] - 2) < EPSILON)
+	assert(linear.gtsv(linear.vector(2), linear.vector(3), linear.vector(2),
+			linear.vector(3)) == false)
+end
+
+-- Tests the gbsv function
+local function testGbsv ()
+	local AB = linear.tolinear({ { 0, -1, -1 }, { 2, 2, 2 }, { -1, -1, 0 } })
+	local b = linear.tolinear({ 0, 0, 4 })
+	assert(linear.gbsv(AB, 1, b) == true)
+	assert(math.abs(b[1] - 1) < EPSILON)
+	assert(math.abs(b[2] - 2) < EPSILON)
+	assert(math.abs(b[3] - 3) < EPSILON)
+	AB = linear.tolinear({ { 0, 1, 1 }, { 4, 4, 4 } })
+	b = linear.tolinear({ 6, 11, 12 })
+	assert(linear.gbsv(AB, 0, b) == true)
+	assert(math.abs(b[1] - 1) < EPSILON)
+	assert(math.abs(b[2] - 2) < EPSILON)
+	assert(math.abs(b[3] - 3) < EPSILON)
+end
+
+-- Tests the pbsv function
+local function testPbsv ()
+	local AB = linear.tolinear({ { 0, -1, -1 }, { 2, 2, 2 } })
+	local b = linear.tolinear({ 0, 0, 4 })
+	assert(linear.pbsv(AB, b) == true)
+	assert(math.abs(b[1] - 1) < EPSILON)
+	assert(math.abs(b[3] - 3) < EPSILON)
+	AB = linear.tolinear({ { 2, -1 }, { 2, -1 }, { 2, 0 } }, "col")
+	local B = linear.tolinear({ { 0, 0 }, { 0, 1 }, { 4, 0 } })
+	assert(linear.pbsv(AB, B, "lower") == true)
+	assert(math.abs(B[2][1] - 2) < EPSILON)
+	assert(math.abs(B[2][2] - 1) < EPSILON)
+	AB = linear.tolinear({ { -2, -2, -2 } })
+	assert(linear.pbsv(AB, b) == false)
+end
+
+-- Tests the gttrf, gbtrf, and pbtrf functions
+local function testBandFactor ()
+	local dl, d, du = linear.tolinear({ -1, -1 }), linear.tolinear({ 2, 2, 2 }),
+			linear.tolinear({ -1, -1 })
+	local solve = linear.gttrf(dl, d, du)
+	local b = linear.tolinear({ 0, 0, 4 })
+	solve(b)
+	assert(math.abs(b[3] - 3) < EPSILON)
+	b = linear.tolinear({ 1, 0, 1 })
+	solve(b)
+	assert(math.abs(b[1] - 1) < EPSILON)
+	assert(math.abs(b[2] - 1) < EPSILON)
+	solve = linear.gbtrf(linear.tolinear({ { 0, -1, -1 }, { 2, 2, 2 }, { -1, -1, 0 } }), 1)
+	local B = linear.tolinear({ { 0, 1 }, { 0, 0 }, { 4, 1 } })
+	solve(B)
+	assert(math.abs(B[1][1] - 1) < EPSILON)
+	assert(math.abs(B[3][2] - 1) < EPSILON)
+	solve = linear.pbtrf(linear.tolinear({ { 0, -1, -1 }, { 2, 2, 2 } }))
+	b = linear.tolinear({ 0, 0, 4 })
+	solve(b)
+	assert(math.abs(b[2] - 2) < EPSILON)
+	assert(linear.gttrf(linear.vector(2), linear.vector(3), linear.vector(2)) == nil)
+	assert(linear.pbtrf(linear.tolinear({ { -2, -2, -2 } })) == nil)
+end
+
 -- Tests the inv function
 local function testInv ()
 	local A = linear.tolinear({ { 8, 1, 6 }, { 3, 5, 7 }, { 4, 9, 2 } })
@@ -969,6 +1582,76 @@ local function testSvd ()
 	assert(math.abs(math.abs(VT[1][1]) - 0.625083) < EPSILON)
 	assert(math.abs(math.abs(VT[1][2]) - 0.575955) < EPSILON)
 	assert(math.abs(math.abs(VT[1][3]) - 0.526827) < EPSILON)
+
+	-- divide-and-conquer
+	A = linear.tolinear({ { 1, 4 }, { 2, 3 }, { 3, 2 } }, "col")
+	U = linear.matrix(2, 2, "col")
+	VT = linear.matrix(3, 3, "col")
+	assert(linear.svd(A, U, s, VT, nil, "gesdd"))
+	assert(math.abs(math.abs(U[1][1]) - 0.536454) < EPSILON)
+	assert(math.abs(math.abs(U[2][1]) - 0.843929) < EPSILON)
+	assert(math.abs(s[1] - 6.258640) < EPSILON)
+	assert(math.abs(s[2] - 1.956890) < EPSILON)
+	assert(math.abs(math.abs(VT[1][1]) - 0.625083) < EPSILON)
+	assert(math.abs(math.abs(VT[3][3]) - 0.408248) < EPSILON)
+end
+
+-- Tests the rsvd function
+local function testRsvd ()
+	local A = linear.matrix(6, 5)
+	for i = 1, 6 do
+		for j = 1, 5 do
+			A[i][j] = i * j + (i + j) % 3
+		end
+	end
+	local B = linear.matrix(6, 5)
+	linear.copy(A, B)
+	local U = linear.matrix(6, 5)
+	local s = linear.vector(5)
+	local VT = linear.matrix(5, 5)
+	assert(linear.svd(B, U, s, VT, 5))
+	local U2 = linear.matrix(6, 2, "col")
+	local s2 = linear.vector(2)
+	local VT2 = linear.matrix(2, 5)
+	assert(linear.rsvd(A, U2, s2, VT2))
+	assert(math.abs(s2[1] - s[1]) < EPSILON)
+	assert(math.abs(s2[2] - s[2]) < EPSILON)
+	for i = 1, 6 do
+		assert(math.abs(math.abs(linear.tvector(U2, i)[1]) - math.abs(U[i][1])) < EPSILON)
+	end
+	for j = 1, 5 do
+		assert(math.abs(math.abs(VT2[1][j]) - math.abs(VT[1][j])) < EPSILON)
+	end
+	assert(A[6][5] == 32)
+
+	-- randomized approximation of a low-rank matrix, with k + oversampling < min(m, n)
+	A = linear.matrix(40, 30)
+	for i = 1, 40 do
+		for j = 1, 30 do
+			A[i][j] = 3 * math.sin(i) * math.cos(j) + 2 * math.cos(0.5 * i) * math.sin(j)
+					+ 0.5 * ((i * j) % 7 - 3)
+		end
+	end
+	B = linear.matrix(40, 30)
+	linear.copy(A, B)
+	U = linear.matrix(40, 30)
+	s = linear.vector(30)
+	VT = linear.matrix(30, 30)
+	assert(linear.svd(B, U, s, VT, 30))
+	local rank = 0
+	for i = 1, 30 do
+		if s[i] > 1E-9 * s[1] then
+			rank = i
+		end
+	end
+	assert(rank < 20)
+	U2 = linear.matrix(40, rank)
+	s2 = linear.vector(rank)
+	VT2 = linear.matrix(rank, 30)
+	assert(linear.rsvd(A, U2, s2, VT2, 4, 1, linear.rng(1)))
+	for i = 1, rank do
+		assert(math.abs(s2[i] - s[i]) < 1E-9 * s[1])
+	end
 end
 
 -- Tests the cov function
@@ -1045,6 +1728,60 @@ local function testQuantile ()
 	for i = 1, 5 do
 		assert(r[i] ~= r[i])
 	end
+
+	-- selection
+	local values = {}
+	for i = 1, 101 do
+		values[i] = (i * 37) % 101 + (i % 3 == 0 and 0 or 0.5)
+	end
+	x = linear.tolinear(values)
+	table.sort(values)
+	r = linear.tolinear({ 0.01, 0.05, 0.5, 0.95, 0.99, 0.995, 1, 0 })
+	linear.quantile(x, r)
+	assert(r[1] == values[2])
+	assert(r[2] == values[6])
+	assert(r[3] == values[51])
+	assert(r[4] == values[96])
+	assert(r[5] == values[100])
+	assert(math.abs(r[6] - (values[100] + values[101]) / 2) < EPSILON)
+	assert(r[7] == values[101])
+	assert(r[8] == values[1])
+
+	-- matrix
+	for _, order in ipairs({ "row", "col" }) do
+		local X = linear.matrix(300, 301, order)
+		for i = 1, 300 do
+			for j = 1, 301 do
+				local v = (i * 7919 + j * 104729) % 1009
+				if order == "row" then
+					X[i][j] = v
+				else
+					X[j][i] = v
+				end
+			end
+		end
+		r = linear.tolinear({ 0.01, 0.05, 0.5, 0.95, 0.99 })
+		local Q = linear.matrix(300, 5)
+		linear.quantile(X, r, Q)
+		for _, i in ipairs({ 1, 150, 300 }) do
+			local q = linear.tolinear({ 0.01, 0.05, 0.5, 0.95, 0.99 })
+			linear.quantile(order == "row" and X[i] or linear.tvector(X, i), q)
+			for j = 1, 5 do
+				assert(Q[i][j] == q[j])
+			end
+		end
+		Q = linear.matrix(5, 301, "col")
+		linear.quantile(X, r, Q, "col")
+		for _, j in ipairs({ 1, 301 }) do
+			local q = linear.tolinear({ 0.01, 0.05, 0.5, 0.95, 0.99 })
+			linear.quantile(order == "col" and X[j] or linear.tvector(X, j), q)
+			for i = 1, 5 do
+				assert(Q[j][i] == q[i])
+			end
+		end
+		assert(r[1] == 0.01)
+		assert(not pcall(linear.quantile, X, r, linear.matrix(5, 300, "col"), "col"))
+	end
 end
 
 -- Tests the rank function
@@ -1068,6 +1805,283 @@ local function testRank ()
 	assert(q[2] ~= q[2])
 end
 
+-- Tests the sort function
+local function testSort ()
+	local x = linear.tolinear({ 3, -1, 0 / 0, 2, -math.huge, 0, math.huge, -2.5 })
+	linear.sort(x)
+	local expected = { -math.huge, -2.5, -1, 0, 2, 3, math.huge }
+	for i = 1, 7 do
+		assert(x[i] == expected[i])
+	end
+	assert(x[8] ~= x[8])
+	local y = linear.vector(8)
+	linear.sort(x, y, "desc")
+	for i = 1, 7 do
+		assert(y[i] == expected[8 - i])
+	end
+	assert(y[8] ~= y[8])
+	assert(x[1] == -math.huge)
+
+	-- radix sort
+	local values = {}
+	for i = 1, 1000 do
+		values[i] = ((i * 7919) % 1000 - 500) * (i % 2 == 0 and 1E-3 or 1E3)
+	end
+	x = linear.tolinear(values)
+	table.sort(values)
+	linear.sort(x)
+	for i = 1, 1000 do
+		assert(x[i] == values[i])
+	end
+	local X = linear.tolinear({ { 3, 1 }, { 1, 2 }, { 2, 3 } })
+	linear.sort(linear.tvector(X, 1), nil, "desc")
+	assert(X[1][1] == 3 and X[2][1] == 2 and X[3][1] == 1)
+	assert(X[1][2] == 1)
+	assert(not pcall(linear.sort, x, linear.vector(2)))
+end
+
+-- Tests the argsort function
+local function testArgsort ()
+	local x = linear.tolinear({ 3, 1, 0 / 0, 2, 1, -1 })
+	local p = linear.vector(6)
+	linear.argsort(x, p)
+	local expected = { 6, 2, 5, 4, 1, 3 }
+	for i = 1, 6 do
+		assert(p[i] == expected[i])
+	end
+	linear.argsort(x, p, "desc")
+	expected = { 1, 4, 2, 5, 6, 3 }
+	for i = 1, 6 do
+		assert(p[i] == expected[i])
+	end
+	local values = {}
+	for i = 1, 1000 do
+		values[i] = (i * 7919) % 100
+	end
+	x = linear.tolinear(values)
+	p = linear.vector(1000)
+	linear.argsort(x, p)
+	for i = 2, 1000 do
+		assert(x[p[i - 1]] < x[p[i]] or x[p[i - 1]] == x[p[i]] and p[i - 1] < p[i])
+	end
+	assert(not pcall(linear.argsort, x, linear.vector(2)))
+end
+
+-- Tests the permute function
+local function testPermute ()
+	local x = linear.tolinear({ 10, 20, 30 })
+	local y = linear.vector(4)
+	linear.permute(x, linear.tolinear({ 3, 1, 2, 3 }), y)
+	assert(y[1] == 30 and y[2] == 10 and y[3] == 20 and y[4] == 30)
+	assert(not pcall(linear.permute, x, linear.tolinear({ 4 }), linear.vector(1)))
+	assert(not pcall(linear.permute, x, linear.tolinear({ 1.5 }), linear.vector(1)))
+	for _, order in ipairs({ "row", "col" }) do
+		local X = linear.matrix(100, 70, order)
+		for i = 1, 100 do
+			for j = 1, 70 do
+				if order == "row" then
+					X[i][j] = i * 1000 + j
+				else
+					X[j][i] = i * 1000 + j
+				end
+			end
+		end
+		local key = linear.vector(100)
+		for i = 1, 100 do
+			key[i] = (i * 37) % 100
+		end
+		local p = linear.vector(100)
+		linear.argsort(key, p)
+		local Y = linear.matrix(100, 70)
+		linear.permute(X, p, Y)
+		for i = 1, 100 do
+			assert(Y[i][1] == p[i] * 1000 + 1)
+			assert(Y[i][70] == p[i] * 1000 + 70)
+		end
+		local q = linear.tolinear({ 70, 1 })
+		local Z = linear.matrix(100, 2, "col")
+		linear.permute(X, q, Z, "col")
+		assert(Z[1][1] == 1070)
+		assert(Z[2][100] == 100001)
+	end
+end
+
+-- Tests the shuffle function
+local function testShuffle ()
+	local x = linear.vector(100)
+	for i = 1, #x do
+		x[i] = i
+	end
+	linear.shuffle(x, linear.rng(1))
+	local seen, moved = {}, 0
+	for i = 1, #x do
+		assert(not seen[x[i]])
+		seen[x[i]] = true
+		if x[i] ~= i then
+			moved = moved + 1
+		end
+	end
+	assert(moved > 50)
+	local y = linear.tolinear({ 1, 2, 3 })
+	local counts = { 0, 0, 0 }
+	for _ = 1, 3000 do
+		linear.shuffle(y)
+		counts[y[1]] = counts[y[1]] + 1
+	end
+	for i = 1, 3 do
+		assert(counts[i] > 800 and counts[i] < 1200)
+	end
+	local A = linear.tolinear({ { 1, 1 }, { 2, 2 }, { 3, 3 }, { 4, 4 } })
+	linear.shuffle(A)
+	local sum = 0
+	for i = 1, 4 do
+		assert(A[i][1] == A[i][2])
+		sum = sum + A[i][1]
+	end
+	assert(sum == 10)
+	A = linear.tolinear({ { 1, 2, 3 }, { 1, 2, 3 } })
+	linear.shuffle(A, "col", linear.rng(1))
+	for j = 1, 3 do
+		assert(A[1][j] == A[2][j])
+	end
+	assert(not pcall(linear.shuffle, {}))
+end
+
+-- Tests the sample function
+local function testSample ()
+	local x = linear.vector(10)
+	for i = 1, #x do
+		x[i] = i
+	end
+	local y = linear.vector(10)
+	linear.sample(x, y, false, linear.rng(1))
+	local seen = {}
+	for i = 1, #y do
+		assert(not seen[y[i]])
+		seen[y[i]] = true
+	end
+	y = linear.vector(10000)
+	linear.sample(x, y, true, linear.rng(1))
+	for i = 1, #y do
+		assert(y[i] >= 1 and y[i] <= 10 and y[i] == math.floor(y[i]))
+	end
+	assert(math.abs(linear.mean(y) - 5.5) < 0.15)
+	assert(not pcall(linear.sample, x, y))
+	local X = linear.tolinear({ { 1, 10 }, { 2, 20 }, { 3, 30 } })
+	local Y = linear.matrix(5, 2, "col")
+	linear.sample(X, Y, true)
+	for i = 1, 5 do
+		assert(Y[1][i] * 10 == Y[2][i])
+	end
+	Y = linear.matrix(2, 2)
+	linear.sample(X, Y)
+	assert(Y[1][1] ~= Y[2][1])
+	assert(not pcall(linear.sample, X, linear.matrix(2, 3)))
+end
+
+-- Tests the searchsorted function
+local function testSearchsorted ()
+	local x = linear.tolinear({ 1, 2, 2, 3, 5 })
+	local v = linear.tolinear({ 0, 1, 2, 2.5, 5, 6, 0 / 0 })
+	local c = linear.vector(7)
+	linear.searchsorted(x, v, c)
+	local expected = { 0, 0, 1, 3, 4, 5 }
+	for i = 1, 6 do
+		assert(c[i] == expected[i])
+	end
+	assert(c[7] ~= c[7])
+	linear.searchsorted(x, v, c, "right")
+	expected = { 0, 1, 3, 3, 5, 5 }
+	for i = 1, 6 do
+		assert(c[i] == expected[i])
+	end
+
+	-- sorted and unsorted queries
+	local X = linear.matrix(1000, 2)
+	for i = 1, 1000 do
+		X[i][1] = math.floor(i / 3)
+	end
+	x = linear.tvector(X, 1)
+	for _, side in ipairs({ "left", "right" }) do
+		local sorted, unsorted = linear.vector(500), linear.vector(500)
+		for i = 1, 500 do
+			sorted[i] = i * 0.7 - 10
+			unsorted[i] = ((i * 7919) % 500) * 0.7 - 10
+		end
+		local cs, cu = linear.vector(500), linear.vector(500)
+		linear.searchsorted(x, sorted, cs, side)
+		linear.searchsorted(x, unsorted, cu, side)
+		for i = 1, 500 do
+			local count = 0
+			for j = 1, 1000 do
+				if x[j] < sorted[i] or side == "right" and x[j] == sorted[i] then
+					count = count + 1
+				end
+			end
+			assert(cs[i] == count)
+		end
+		for i = 1, 500 do
+			local k = (i * 7919) % 500
+			if k > 0 then
+				assert(cu[i] == cs[k])
+			end
+		end
+	end
+	assert(not pcall(linear.searchsorted, x, v, linear.vector(2)))
+end
+
+-- Tests the topk function
+local function testTopk ()
+	local x = linear.tolinear({ 3, 0 / 0, 7, 1, 7, -2, 5 })
+	local v, p = linear.vector(3), linear.vector(3)
+	linear.topk(x, v, p)
+	assert(v[1] == 7 and v[2] == 7 and v[3] == 5)
+	assert(p[1] == 3 and p[2] == 5 and p[3] == 7)
+	linear.topk(x, v, nil, "asc")
+	assert(v[1] == -2 and v[2] == 1 and v[3] == 3)
+	v, p = linear.vector(7), linear.vector(7)
+	linear.topk(x, v, p, "asc")
+	assert(v[6] == 7 and v[7] ~= v[7] and p[7] == 2)
+	assert(not pcall(linear.topk, x, linear.vector(8)))
+
+	-- heap selection
+	local values = {}
+	for i = 1, 1000 do
+		values[i] = (i * 7919) % 1000
+	end
+	x = linear.tolinear(values)
+	v, p = linear.vector(100), linear.vector(100)
+	linear.topk(x, v, p)
+	table.sort(values, function (a, b) return a > b end)
+	for i = 1, 100 do
+		assert(v[i] == values[i])
+		assert(x[p[i]] == v[i])
+	end
+
+	-- matrix
+	for _, order in ipairs({ "row", "col" }) do
+		local X = linear.matrix(3, 50, order)
+		for i = 1, 3 do
+			for j = 1, 50 do
+				local value = (i * 31 + j * 17) % 50
+				if order == "row" then
+					X[i][j] = value
+				else
+					X[j][i] = value
+				end
+			end
+		end
+		local V, P = linear.matrix(3, 5), linear.matrix(3, 5, "col")
+		linear.topk(X, V, P)
+		for i = 1, 3 do
+			for j = 1, 5 do
+				assert(V[i][j] == 50 - j)
+				assert(P[j][i] >= 1 and P[j][i] <= 50)
+			end
+		end
+	end
+end
+
 -- Tests the spline function
 local function testSpline ()
 	local x = linear.vector(9)
@@ -1101,6 +2115,269 @@ local function testSpline ()
 	spline = linear.spline(x, y, nil, "cubic")
 	assert(math.abs(spline(-0.01) - (-0.01)) < 1E-3)
 	assert(math.abs(spline(2 * math.pi + 0.01) - 0.01) < 1E-3)
+
+	-- vector evaluation
+	spline = linear.spline(x, y)
+	local u, v = linear.vector(129), linear.vector(129)
+	for i = 0, 128 do
+		u[i + 1] = i * math.pi / 64
+	end
+	spline(u, v)
+	for i = 1, 129 do
+		assert(v[i] == spline(u[i]))
+	end
+	u[1], u[129] = u[129], u[1]
+	spline(u, v)
+	assert(v[1] == spline(2 * math.pi))
+	assert(v[129] == spline(0))
+	assert(not pcall(spline, linear.tolinear({ 0, 7 }), linear.vector(2)))
+
+	-- derivative and integral
+	for i = 0, 128 do
+		local a = i * math.pi / 64
+		assert(math.abs(math.cos(a) - spline(a, "derivative")) < 1E-1)
+		assert(math.abs(1 - math.cos(a) - spline(a, "integral")) < 1E-2)
+	end
+	assert(spline(0, "integral") == 0)
+	spline(u, v, "integral")
+	assert(math.abs(v[1]) < 1E-2)
+	spline = linear.spline(x, y, nil, "const")
+	assert(spline(-1, "derivative") == 0)
+	assert(spline(-1, "integral") == 0)
+	assert(math.abs(spline(2 * math.pi + 1, "integral") - spline(2 * math.pi, "integral"))
+			< EPSILON)
+
+	-- multiple curves
+	for _, order in ipairs({ "row", "col" }) do
+		local Y = linear.matrix(9, 2, order)
+		local z = linear.vector(9)
+		for i = 1, 9 do
+			local a = x[i]
+			Y[order == "row" and i or 1][order == "row" and 1 or i] = math.sin(a)
+			Y[order == "row" and i or 2][order == "row" and 2 or i] = math.cos(a)
+			z[i] = math.cos(a)
+		end
+		local splines = linear.spline(x, Y, "natural", "linear")
+		local sin, cos = linear.spline(x, y, "natural", "linear"),
+				linear.spline(x, z, "natural", "linear")
+		local w = linear.vector(2)
+		for _, a in ipairs({ -0.5, 0, 1, 2.5, 2 * math.pi, 7 }) do
+			splines(a, w)
+			assert(math.abs(w[1] - sin(a)) < EPSILON)
+			assert(math.abs(w[2] - cos(a)) < EPSILON)
+			splines(a, w, "integral")
+			assert(math.abs(w[2] - cos(a, "integral")) < EPSILON)
+		end
+		local W = linear.matrix(129, 2)
+		splines(u, W, "derivative")
+		for i = 1, 129 do
+			assert(math.abs(W[i][1] - sin(u[i], "derivative")) < EPSILON)
+			assert(math.abs(W[i][2] - cos(u[i], "derivative")) < EPSILON)
+		end
+		assert(not pcall(splines, 1, linear.vector(3)))
+	end
+
+	-- uniform and log-uniform grids
+	local grids = {
+		{ 0, 0.5, 1, 1.5, 2, 2.5, 3 },
+		{ 1, 2, 4, 8, 16, 32, 64 },
+		{ 0, 0.5, 1, 1.75, 2, 2.5, 3 },
+	}
+	for _, grid in ipairs(grids) do
+		local gx, gy = linear.tolinear(grid), linear.vector(#grid)
+		for i = 1, #grid do
+			gy[i] = math.sqrt(grid[i])
+		end
+		local f = linear.spline(gx, gy, "natural", "const")
+		for i = 1, #grid do
+			assert(math.abs(f(grid[i]) - gy[i]) < EPSILON)
+		end
+		gx[2] = gx[2] + 1E-7  -- general grid
+		local g = linear.spline(gx, gy, "natural", "const")
+		local gu, gv = linear.vector(200), linear.vector(200)
+		for i = 1, 200 do
+			gu[i] = grid[1] - 1 + (grid[#grid] - grid[1] + 2) * ((i * 37) % 200) / 200
+		end
+		f(gu, gv)
+		for i = 1, 200 do
+			assert(math.abs(gv[i] - g(gu[i])) < 1E-5)
+		end
+	end
+end
+
+-- Tests the interp function
+local function testInterp ()
+	local xp = linear.tolinear({ 0, 1, 3 })
+	local fp = linear.tolinear({ 0, 2, 3 })
+	local x = linear.tolinear({ 0, 0.5, 1, 2, 3 })
+	local y = linear.vector(5)
+	linear.interp(xp, fp, x, y)
+	assert(y[1] == 0)
+	assert(y[2] == 1)
+	assert(y[3] == 2)
+	assert(y[4] == 2.5)
+	assert(y[5] == 3)
+	x = linear.tolinear({ 2, 0.5, 3, 0 })
+	y = linear.vector(4)
+	linear.interp(xp, fp, x, y)
+	assert(y[1] == 2.5)
+	assert(y[2] == 1)
+	assert(y[3] == 3)
+	assert(y[4] == 0)
+
+	-- extrapolation
+	x = linear.tolinear({ -1, 4 })
+	y = linear.vector(2)
+	assert(not pcall(linear.interp, xp, fp, x, y))
+	linear.interp(xp, fp, x, y, "const")
+	assert(y[1] == 0)
+	assert(y[2] == 3)
+	linear.interp(xp, fp, x, y, "linear")
+	assert(y[1] == -2)
+	assert(y[2] == 3.5)
+	assert(not pcall(linear.interp, xp, fp, linear.tolinear({ 0 / 0 }), linear.vector(1)))
+	assert(not pcall(linear.interp, linear.tolinear({ 0, 0 }), linear.vector(2), x, y))
+
+	-- multiple series
+	local FP = linear.tolinear({ { 0, 1, 3 }, { 0, -2, -3 } }, "col")
+	x = linear.tolinear({ 3, 0.5, -1 })
+	local Y = linear.matrix(3, 2)
+	linear.interp(xp, FP, x, Y, "linear")
+	assert(Y[1][1] == 3)
+	assert(Y[1][2] == -3)
+	assert(Y[2][1] == 0.5)
+	assert(Y[2][2] == -1)
+	assert(Y[3][1] == -1)
+	assert(Y[3][2] == 2)
+end
+
+
+--
+-- Sparse matrix functions
+--
+
+-- Tests the sparse function
+local function testSparse ()
+	-- triplets
+	local i = linear.tolinear({ 3, 1, 2, 1, 3 })
+	local j = linear.tolinear({ 1, 3, 2, 1, 1 })
+	local v = linear.tolinear({ 1, 2, 3, 4, 5 })
+	local S = linear.sparse(3, 4, i, j, v)
+	assert(linear.type(S) == "sparse")
+	local rows, cols, nnz = linear.size(S)
+	assert(rows == 3)
+	assert(cols == 4)
+	assert(nnz == 4)
+	local X = linear.matrix(3, 4)
+	linear.spdense(S, X)
+	assert(X[1][1] == 4)
+	assert(X[1][3] == 2)
+	assert(X[2][2] == 3)
+	assert(X[3][1] == 6)
+	assert(X[3][4] == 0)
+
+	-- dense
+	X = linear.tolinear({ { 0, 1, 0 }, { 0.1, 0, 2 } }, "col")
+	S = linear.sparse(X, 0.5)
+	rows, cols, nnz = linear.size(S)
+	assert(rows == 3)
+	assert(cols == 2)
+	assert(nnz == 2)
+	local Y = linear.matrix(3, 2)
+	linear.spdense(S, Y)
+	assert(Y[1][1] == 0)
+	assert(Y[2][1] == 1)
+	assert(Y[2][2] == 0)
+	assert(Y[3][2] == 2)
+end
+
+-- Tests the spmv function
+local function testSpmv ()
+	local A = linear.tolinear({ { 1, 0, 2 }, { 0, 0, 3 } })
+	local S = linear.sparse(A)
+	local x = linear.tolinear({ 1, 2, 3 })
+	local y = linear.tolinear({ 1, 1 })
+	linear.spmv(S, x, y, nil, 2, 1)
+	assert(y[1] == 15)
+	assert(y[2] == 19)
+	x = linear.tolinear({ 1, 2 })
+	y = linear.vector(3)
+	linear.spmv(S, x, y, "trans")
+	assert(y[1] == 1)
+	assert(y[2] == 0)
+	assert(y[3] == 8)
+
+	-- parallel
+	local n = 400
+	A = linear.matrix(n, n)
+	for i = 1, n do
+		for j = 1, n do
+			if (i * 7 + j * 13) % 3 ~= 0 then
+				A[i][j] = i - j
+			end
+		end
+	end
+	S = linear.sparse(A)
+	assert(select(3, linear.size(S)) > 65536)
+	x = linear.vector(n)
+	for i = 1, n do
+		x[i] = i % 5
+	end
+	local y1, y2 = linear.vector(n), linear.vector(n)
+	linear.spmv(S, x, y1)
+	linear.gemv(A, x, y2)
+	for i = 1, n do
+		assert(y1[i] == y2[i])
+	end
+end
+
+-- Tests the spmm function
+local function testSpmm ()
+	local A = linear.tolinear({ { 1, 0, 2 }, { 0, 0, 3 } })
+	local S = linear.sparse(A)
+	local B = linear.tolinear({ { 1, 2 }, { 3, 4 }, { 5, 6 } })
+	local C = linear.matrix(2, 2, "col")
+	linear.spmm(S, B, C)
+	assert(C[1][1] == 11)
+	assert(C[1][2] == 15)
+	assert(C[2][1] == 14)
+	assert(C[2][2] == 18)
+	B = linear.tolinear({ { 1, 2 }, { 3, 4 } })
+	C = linear.matrix(3, 2)
+	linear.set(C, 1)
+	linear.spmm(S, B, C, "trans", 1, 1)
+	assert(C[1][1] == 2)
+	assert(C[1][2] == 3)
+	assert(C[2][1] == 1)
+	assert(C[2][2] == 1)
+	assert(C[3][1] == 12)
+	assert(C[3][2] == 17)
+end
+
+-- Tests the spscal function
+local function testSpscal ()
+	local S = linear.sparse(linear.tolinear({ { 1, 0, 2 }, { 0, 0, 3 } }))
+	linear.spscal(S, linear.tolinear({ 2, 3 }))
+	linear.spscal(S, linear.tolinear({ 1, 0, -1 }), "right")
+	local X = linear.matrix(2, 3)
+	linear.spdense(S, X)
+	assert(X[1][1] == 2)
+	assert(X[1][3] == -4)
+	assert(X[2][3] == -9)
+end
+
+-- Tests the spsum function
+local function testSpsum ()
+	local S = linear.sparse(linear.tolinear({ { 1, 0, 2 }, { 0, 0, 3 } }))
+	local y = linear.vector(2)
+	linear.spsum(S, y)
+	assert(y[1] == 3)
+	assert(y[2] == 3)
+	y = linear.vector(3)
+	linear.spsum(S, y, "col")
+	assert(y[1] == 1)
+	assert(y[2] == 0)
+	assert(y[3] == 5)
 end
 
 -- Core function tests
@@ -1116,6 +2393,9 @@ testSub()
 testUnwind()
 testReshape()
 testRandomseed()
+testRng()
+testProfile()
+testTrace()
 
 -- Elementary function tests
 testInc()
@@ -1135,6 +2415,12 @@ testNormal()
 testNormalPdf()
 testNormalCdf()
 testNormalQf()
+testExponential()
+testGamma()
+testBeta()
+testPoisson()
+testBinomial()
+testStudentT()
 
 -- Unary vector function tests
 testSum()
@@ -1162,14 +2448,43 @@ testDot()
 testGer()
 testGemv()
 testGemm()
+testTrmv()
+testTrsv()
+testTrmm()
+testTrsm()
+testSyr()
+testSymv()
+testSymm()
+testSyrk()
+testSyr2k()
 testGesv()
 testGels()
+testGtsv()
+testGbsv()
+testPbsv()
+testBandFactor()
 testInv()
 testDet()
 testSvd()
+testRsvd()
 testCov()
 testCorr()
 testRanks()
 testQuantile()
 testRank()
+testSort()
+testArgsort()
+testPermute()
+testShuffle()
+testSample()
+testSearchsorted()
+testTopk()
 testSpline()
+testInterp()
+
+-- Sparse matrix function tests
+testSparse()
+testSpmv()
+testSpmm()
+testSpscal()
+testSpsum()